@@ -111,19 +111,33 @@ void cpuid(uint32_t in, CpuId* out) ASMJIT_NOTHROW
   asm ("mov %%ebx, %%edi\n"    \
        "cpuid\n"               \
        "xchg %%edi, %%ebx\n"   \
-       : "=a" (a), "=D" (b), "=c" (c), "=d" (d) : "a" (inp))
+       : "=a" (a), "=D" (b), "=c" (c), "=d" (d) : "a" (inp), "c" (0))
 # else
 #  define __mycpuid(a, b, c, d, inp) \
   asm ("mov %%rbx, %%rdi\n"    \
        "cpuid\n"               \
        "xchg %%rdi, %%rbx\n"   \
-       : "=a" (a), "=D" (b), "=c" (c), "=d" (d) : "a" (inp))
+       : "=a" (a), "=D" (b), "=c" (c), "=d" (d) : "a" (inp), "c" (0))
 # endif
   __mycpuid(out->eax, out->ebx, out->ecx, out->edx, in);
 
 #endif // compiler
 }
 
+// Returns the register state enabled by the operating system (XCR0).
+static uint64_t xgetbv0() ASMJIT_NOTHROW
+{
+#if defined(_MSC_VER) && _MSC_VER >= 1600
+  return _xgetbv(0);
+#elif defined(__GNUC__)
+  uint32_t lo, hi;
+  asm (".byte 0x0F, 0x01, 0xD0" : "=a" (lo), "=d" (hi) : "c" (0));
+  return ((uint64_t)hi << 32) | lo;
+#else
+  return 0;
+#endif
+}
+
 struct CpuVendorInfo
 {
   uint32_t id;
@@ -205,6 +219,8 @@ void detectCpuInfo(CpuInfo* i) ASMJIT_NOTHROW
   // Get vendor string
   cpuid(0, &out);
 
+  uint32_t maxId = out.eax;
+
   memcpy(i->vendor, &out.ebx, 4);
   memcpy(i->vendor + 4, &out.edx, 4);
   memcpy(i->vendor + 8, &out.ecx, 4);
@@ -259,12 +275,30 @@ void detectCpuInfo(CpuInfo* i) ASMJIT_NOTHROW
   if (out.edx & 0x04000000U) i->features |= CPU_FEATURE_SSE | CPU_FEATURE_SSE2;
   if (out.edx & 0x10000000U) i->features |= CPU_FEATURE_MULTI_THREADING;
 
+  // XCR0 tells whether the OS saves the YMM (bits 1-2) and the
+  // opmask/ZMM (bits 5-7) state, without which AVX can't be used.
+  uint64_t xcr0 = (out.ecx & 0x08000000U) ? xgetbv0() : 0;
+  bool saveYmm = (xcr0 & 0x06) == 0x06;
+  bool saveZmm = (xcr0 & 0xE6) == 0xE6;
+
   if (i->vendorId == CPU_VENDOR_AMD && (out.edx & 0x10000000U))
   {
     // AMD sets Multithreading to ON if it has more cores.
     if (i->numberOfProcessors == 1) i->numberOfProcessors = 2;
   }
 
+  // Structured extended features (subleaf 0).
+  if (maxId >= 7)
+  {
+    CpuId ext;
+    cpuid(7, &ext);
+
+    if ((ext.ebx & 0x00000020U) && saveYmm) i->extendedFeatures |= CPU_EXTENDED_FEATURE_AVX2;
+    if ((ext.ebx & 0x00010000U) && saveZmm) i->extendedFeatures |= CPU_EXTENDED_FEATURE_AVX512F;
+    if (ext.ebx & 0x00000200U) i->extendedFeatures |= CPU_EXTENDED_FEATURE_ERMS;
+    if (ext.ebx & 0x00800000U) i->extendedFeatures |= CPU_EXTENDED_FEATURE_CLFLUSHOPT;
+  }
+
   // This comment comes from V8 and I think that its important:
   //
   // Opteron Rev E has a bug in which on very rare occasions a locked
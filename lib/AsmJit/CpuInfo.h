@@ -166,6 +166,26 @@ enum CPU_FEATURE
   CPU_FEATURE_64_BIT = 1U << 31
 };
 
+// ============================================================================
+// [AsmJit::CPU_EXTENDED_FEATURE]
+// ============================================================================
+
+//! @brief X86/X64 CPU features reported by cpuid leaf 7.
+//!
+//! Vector extensions are only reported when the operating system also saves
+//! the corresponding register state (checked through XGETBV).
+enum CPU_EXTENDED_FEATURE
+{
+  //! @brief Cpu has AVX2.
+  CPU_EXTENDED_FEATURE_AVX2 = 1U << 0,
+  //! @brief Cpu has AVX-512 foundation instructions.
+  CPU_EXTENDED_FEATURE_AVX512F = 1U << 1,
+  //! @brief Cpu supports enhanced REP MOVSB/STOSB.
+  CPU_EXTENDED_FEATURE_ERMS = 1U << 2,
+  //! @brief Cpu has CLFLUSHOPT instruction.
+  CPU_EXTENDED_FEATURE_CLFLUSHOPT = 1U << 3
+};
+
 // ============================================================================
 // [AsmJit::CPU_BUG]
 // ============================================================================
@@ -201,6 +221,8 @@ struct ASMJIT_HIDDEN CpuInfo
   uint32_t numberOfProcessors;
   //! @brief Cpu features bitfield, see @c AsmJit::CpuInfo::Feature enum).
   uint32_t features;
+  //! @brief Cpu extended features bitfield, see @c AsmJit::CPU_EXTENDED_FEATURE enum).
+  uint32_t extendedFeatures;
   //! @brief Cpu bugs bitfield, see @c AsmJit::CpuInfo::Bug enum).
   uint32_t bugs;
 
@@ -0,0 +1,43 @@
+#!/bin/sh
+
+#
+# Initialisation
+#
+
+# Configurable variables
+chase=${1:-chase}
+
+# A 32 GB chain of 1 MB lines holds 2^32 links, but only
+# the first and last page of every line is ever touched
+options="--check -l 1m -p 1m -c 32g -i 1 -e 1 -o both"
+lines=32768
+
+
+#
+# Test
+#
+
+for access in "forward 1" "reverse 1" "forward 3"
+do
+    # chase fails when a chain is not a single cycle
+    result=$($chase $options -a $access)
+    if [ $? -ne 0 ]
+    then
+        echo "FAIL: $access did not close into a single cycle"
+        exit 1
+    fi
+
+    # pick the operations per chain out of the csv
+    ops=$(echo "$result" | awk -F, '
+        NR == 1 { for (i = 1; i <= NF; i++) if ($i == "operations per chain") c = i }
+        NR == 2 { print $c }')
+
+    stride=${access#* }
+    expected=$(( (lines + stride - 1) / stride ))
+    if [ "$ops" -ne "$expected" ]
+    then
+        echo "FAIL: $access visited $ops lines instead of $expected"
+        exit 1
+    fi
+    echo "PASS: $access visited $ops lines"
+done
@@ -22,12 +22,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
 #if defined(NUMA)
 #include <numa.h>
 #endif
 
 // Local includes
+#include <AsmJit/CpuInfo.h>
 #include "chain.h"
+#include "native.h"
+#include "memory.h"
 
 
 //
@@ -35,9 +41,9 @@
 //
 
 Experiment::Experiment() :
-    strict           (false),
     pointer_size     (DEFAULT_POINTER_SIZE),
     bytes_per_line   (DEFAULT_BYTES_PER_LINE),
+    bytes_per_stride (DEFAULT_BYTES_PER_LINE),
     links_per_line   (DEFAULT_LINKS_PER_LINE),
     bytes_per_page   (DEFAULT_BYTES_PER_PAGE),
     lines_per_page   (DEFAULT_LINES_PER_PAGE),
@@ -46,29 +52,82 @@ Experiment::Experiment() :
     lines_per_chain  (DEFAULT_LINES_PER_CHAIN),
     links_per_chain  (DEFAULT_LINKS_PER_CHAIN),
     pages_per_chain  (DEFAULT_PAGES_PER_CHAIN),
-    chains_per_thread(DEFAULT_CHAINS_PER_THREAD),
+    pages_per_segment(DEFAULT_PAGES_PER_CHAIN),
     bytes_per_thread (DEFAULT_BYTES_PER_THREAD),
+    chains_per_thread(DEFAULT_CHAINS_PER_THREAD),
     num_threads      (DEFAULT_THREADS),
     bytes_per_test   (DEFAULT_BYTES_PER_TEST),
     loop_length      (DEFAULT_LOOPLENGTH),
+    unroll           (DEFAULT_UNROLL),
+    bytes_per_node   (0),
+    node_simd        (false),
     seconds          (DEFAULT_SECONDS),
     iterations       (DEFAULT_ITERATIONS),
     experiments      (DEFAULT_EXPERIMENTS),
     prefetch_hint    (NONE),
+    prefetch_distance(DEFAULT_PREFETCH_DISTANCE),
+    prefetch_sweep   (false),
+    chase_engine     (SCALAR),
+    gather_width     (0),
+    memory_operation (LOAD),
+    payload_offset   (sizeof(Chain)),
+    link_placement   (LINK_FIRST),
     output_mode      (TABLE),
     access_pattern   (RANDOM),
     stride           (1),
+    bytes_per_window (0),
+    zipf_exponent    (0),
+    hot_fraction     (0),
+    hot_share        (0),
+    trace_file       (NULL),
+    trace            (NULL),
+    trace_length     (0),
+    trace_skipped    (0),
+    visits           (NULL),
+    capped_lines     (0),
+    effective_share  (0),
+    page_order       (ORDER_SEQUENTIAL),
+    page_stride      (1),
+    line_order       (ORDER_SEQUENTIAL),
+    line_stride      (1),
     numa_placement   (LOCAL),
     offset_or_mask   (0),
     placement_map    (NULL),
+    interleave_nodes (NULL),
+    interleave_length(0),
+    numa_policy      (POLICY_STRICT),
+    pages_checked    (0),
+    pages_misplaced  (0),
+    numa_matrix      (false),
     thread_domain    (NULL),
     chain_domain     (NULL),
     numa_max_domain  (0),
-    num_numa_domains (1)
+    num_numa_domains (1),
+    cpu_domains      (NULL),
+    num_cpu_domains  (0),
+    memory_domains   (NULL),
+    num_memory_domains(0),
+    strict           (false),
+    cold             (false),
+    check            (false),
+    shared_chain     (false),
+    page_backing     (PAGES_DEFAULT),
+    backing_page_size(0),
+    huge_page_share  (0)
 {
 }
 
 Experiment::~Experiment() {
+	if (this->trace != NULL)
+		delete[] this->trace;
+	if (this->visits != NULL)
+		delete[] this->visits;
+	if (this->interleave_nodes != NULL)
+		delete[] this->interleave_nodes;
+	if (this->cpu_domains != NULL)
+		delete[] this->cpu_domains;
+	if (this->memory_domains != NULL)
+		delete[] this->memory_domains;
 }
 
 // interface:
@@ -81,9 +140,51 @@ Experiment::~Experiment() {
 // -i or --iters            iterations
 // -e or --experiments      experiments
 // -g or --loop				cycles to execute for each iteration (latency hiding)
+// -u or --unroll           links chased per chain between loop tests
+// --node-size             bytes read by each hop
+// --node-simd             read nodes with SIMD loads
 // -f or --prefetch			use of prefetching
+// --prefetch-distance     hops the prefetching cursor runs ahead
+//         <number>         fixed distance
+//         sweep            distances 0, 1, 2, 4, ... up to 64
+// --engine                code used to chase the chains
+//         scalar           JIT-compiled loads, one per chain
+//         gather           JIT-compiled AVX2/AVX-512 gathers
+//         native           compiled C++ kernels, no JIT
+//         stream           store bandwidth of several store instructions
+// --op                    operation performed on each line
+//         load             follow the link only
+//         store            also store to a payload word
+//         rmw              also increment a payload word
+// --link                  position of the link within its line
+//         first            first word of the line
+//         last             last word of the line
+//         random           a random word of the line
+//         split-line       straddling the end of the line
+//         split-page       straddling the end of a page
+// --cold                  flush the chains before each iteration
+// --check                 verify every chain is a single cycle
+// --shared                all threads build and chase a single chain
+// --pages                 pages backing the chains
+//         default          whatever the system decides
+//         4k               base pages, transparent huge pages disabled
+//         thp              transparent huge pages
+//         2m               2 MB pages of the hugetlb pool
+//         1g               1 GB pages of the hugetlb pool
 // -a or --access           memory access pattern
 //         random           random access pattern
+//         permute          uniform random cycle over all lines
+//         permute-pages    uniform random order of pages, then of lines
+//         window <size>    random within consecutive windows of <size> bytes
+//         zipf <s>         line popularity following Zipf(s)
+//         hotcold <f> <q>  fraction <f> of the lines gets share <q> of the visits
+// --trace                 replay the addresses recorded in a file
+// --page-order            order of the pages within a chain
+// --line-order            order of the lines within a page
+//         sequential       ascending order
+//         reverse          descending order
+//         strided <n>      every nth one, then every nth one from the next
+//         random           uniform random order
 //         forward <stride> exclusive OR and mask
 //         reverse <stride> addition and offset
 // -o or --output           output mode
@@ -96,10 +197,19 @@ Experiment::~Experiment() {
 //         xor <mask>       exclusive OR and mask
 //         add <offset>     addition and offset
 //         map <map>        explicit mapping of threads and chains to domains
+//         interleave <nodes> pages of every chain spread across domains
+//         cpuless          chains on domains with memory but no cpus
+// --mempolicy             numa memory policy of each chain
+//         strict           only the domain of the chain
+//         preferred        the domain of the chain, others when it is full
+//         interleave       all domains with memory, page by page
+// --numa-matrix           latency and bandwidth between all pairs of domains
 
 int Experiment::parse_args(int argc, char* argv[]) {
 	bool error = false;
 	bool usage = false;
+	bool access = false;	// -a was given
+	bool ordered = false;	// --page-order or --line-order was given
 	const size_t errorStringSize = 100;
 	char errorString[errorStringSize] = "unknown error";
 	for (int i = 1; i < argc; i++) {
@@ -109,6 +219,36 @@ int Experiment::parse_args(int argc, char* argv[]) {
 		} else if (strcasecmp(argv[i], "-x") == 0
 				|| strcasecmp(argv[i], "--strict") == 0) {
 			this->strict = true;
+		} else if (strcasecmp(argv[i], "--cold") == 0) {
+			this->cold = true;
+		} else if (strcasecmp(argv[i], "--check") == 0) {
+			this->check = true;
+		} else if (strcasecmp(argv[i], "--shared") == 0) {
+			this->shared_chain = true;
+		} else if (strcasecmp(argv[i], "--numa-matrix") == 0) {
+			this->numa_matrix = true;
+		} else if (strcasecmp(argv[i], "--pages") == 0) {
+			i++;
+			if (i == argc) {
+				strncpy(errorString, "page backing missing", errorStringSize);
+				error = true;
+				break;
+			}
+			if (strcasecmp(argv[i], "default") == 0) {
+				this->page_backing = PAGES_DEFAULT;
+			} else if (strcasecmp(argv[i], "4k") == 0) {
+				this->page_backing = PAGES_4K;
+			} else if (strcasecmp(argv[i], "thp") == 0) {
+				this->page_backing = PAGES_THP;
+			} else if (strcasecmp(argv[i], "2m") == 0) {
+				this->page_backing = PAGES_2M;
+			} else if (strcasecmp(argv[i], "1g") == 0) {
+				this->page_backing = PAGES_1G;
+			} else {
+				snprintf(errorString, errorStringSize, "invalid page backing -- '%s'", argv[i]);
+				error = true;
+				break;
+			}
 		} else if (strcasecmp(argv[i], "-s") == 0
 				|| strcasecmp(argv[i], "--seconds") == 0) {
 			i++;
@@ -237,6 +377,36 @@ int Experiment::parse_args(int argc, char* argv[]) {
 				error = true;
 				break;
 			}
+		} else if (strcasecmp(argv[i], "-u") == 0
+				|| strcasecmp(argv[i], "--unroll") == 0) {
+			i++;
+			if (i == argc) {
+				strncpy(errorString, "unroll factor missing", errorStringSize);
+				error = true;
+				break;
+			}
+			this->unroll = Experiment::parse_number(argv[i]);
+			if (this->unroll == 0) {
+				strncpy(errorString, "invalid unroll factor", errorStringSize);
+				error = true;
+				break;
+			}
+		} else if (strcasecmp(argv[i], "--node-size") == 0) {
+			i++;
+			if (i == argc) {
+				strncpy(errorString, "node size missing", errorStringSize);
+				error = true;
+				break;
+			}
+			this->bytes_per_node = Experiment::parse_number(argv[i]);
+			if (this->bytes_per_node < MIN_BYTES_PER_NODE || MAX_BYTES_PER_NODE < this->bytes_per_node
+					|| (this->bytes_per_node & (this->bytes_per_node - 1)) != 0) {
+				snprintf(errorString, errorStringSize, "node size must be a power of two from %d to %d bytes", MIN_BYTES_PER_NODE, MAX_BYTES_PER_NODE);
+				error = true;
+				break;
+			}
+		} else if (strcasecmp(argv[i], "--node-simd") == 0) {
+			this->node_simd = true;
 		} else if (strcasecmp(argv[i], "-f") == 0
 				|| strcasecmp(argv[i], "--prefetch") == 0) {
 			i++;
@@ -260,8 +430,128 @@ int Experiment::parse_args(int argc, char* argv[]) {
 				error = true;
 				break;
 			}
+		} else if (strcasecmp(argv[i], "--prefetch-distance") == 0) {
+			i++;
+			if (i == argc) {
+				strncpy(errorString, "prefetch distance missing", errorStringSize);
+				error = true;
+				break;
+			}
+			if (strcasecmp(argv[i], "sweep") == 0) {
+				this->prefetch_sweep = true;
+			} else {
+				this->prefetch_distance = Experiment::parse_number(argv[i]);
+				if (this->prefetch_distance < 0 || MAX_PREFETCH_DISTANCE < this->prefetch_distance) {
+					snprintf(errorString, errorStringSize, "prefetch distance must be between 0 and %d", MAX_PREFETCH_DISTANCE);
+					error = true;
+					break;
+				}
+			}
+		} else if (strcasecmp(argv[i], "--engine") == 0) {
+			i++;
+			if (i == argc) {
+				strncpy(errorString, "chase engine missing", errorStringSize);
+				error = true;
+				break;
+			}
+			if (strcasecmp(argv[i], "scalar") == 0) {
+				this->chase_engine = SCALAR;
+			} else if (strcasecmp(argv[i], "gather") == 0) {
+				this->chase_engine = GATHER;
+			} else if (strcasecmp(argv[i], "native") == 0) {
+				this->chase_engine = NATIVE;
+			} else if (strcasecmp(argv[i], "stream") == 0) {
+				this->chase_engine = STREAM;
+			} else {
+				snprintf(errorString, errorStringSize, "invalid chase engine -- '%s'", argv[i]);
+				error = true;
+				break;
+			}
+		} else if (strcasecmp(argv[i], "--op") == 0) {
+			i++;
+			if (i == argc) {
+				strncpy(errorString, "memory operation missing", errorStringSize);
+				error = true;
+				break;
+			}
+			if (strcasecmp(argv[i], "load") == 0) {
+				this->memory_operation = LOAD;
+			} else if (strcasecmp(argv[i], "store") == 0) {
+				this->memory_operation = STORE;
+			} else if (strcasecmp(argv[i], "rmw") == 0) {
+				this->memory_operation = RMW;
+			} else {
+				snprintf(errorString, errorStringSize, "invalid memory operation -- '%s'", argv[i]);
+				error = true;
+				break;
+			}
+		} else if (strcasecmp(argv[i], "--link") == 0) {
+			i++;
+			if (i == argc) {
+				strncpy(errorString, "link placement missing", errorStringSize);
+				error = true;
+				break;
+			}
+			if (strcasecmp(argv[i], "first") == 0) {
+				this->link_placement = LINK_FIRST;
+			} else if (strcasecmp(argv[i], "last") == 0) {
+				this->link_placement = LINK_LAST;
+			} else if (strcasecmp(argv[i], "random") == 0) {
+				this->link_placement = LINK_RANDOM;
+			} else if (strcasecmp(argv[i], "split-line") == 0) {
+				this->link_placement = LINK_SPLIT_LINE;
+			} else if (strcasecmp(argv[i], "split-page") == 0) {
+				this->link_placement = LINK_SPLIT_PAGE;
+			} else {
+				snprintf(errorString, errorStringSize, "invalid link placement -- '%s'", argv[i]);
+				error = true;
+				break;
+			}
+		} else if (strcasecmp(argv[i], "--trace") == 0) {
+			i++;
+			if (i == argc) {
+				strncpy(errorString, "trace file missing", errorStringSize);
+				error = true;
+				break;
+			}
+			this->trace_file = argv[i];
+			this->access_pattern = TRACE;
+			access = true;
+		} else if (strcasecmp(argv[i], "--page-order") == 0
+				|| strcasecmp(argv[i], "--line-order") == 0) {
+			bool pages = strcasecmp(argv[i], "--page-order") == 0;
+			int32 &order = pages ? this->page_order : this->line_order;
+			int64 &stride = pages ? this->page_stride : this->line_stride;
+			i++;
+			if (i == argc) {
+				strncpy(errorString, pages ? "page order missing" : "line order missing", errorStringSize);
+				error = true;
+				break;
+			}
+			order = parse_order(argv[i]);
+			if (order < 0) {
+				snprintf(errorString, errorStringSize, "invalid %s order -- '%s'", pages ? "page" : "line", argv[i]);
+				error = true;
+				break;
+			}
+			if (order == ORDER_STRIDED) {
+				i++;
+				if (i == argc) {
+					strncpy(errorString, "stride of strided order missing", errorStringSize);
+					error = true;
+					break;
+				}
+				stride = Experiment::parse_number(argv[i]);
+				if (stride <= 0) {
+					strncpy(errorString, "invalid stride of strided order", errorStringSize);
+					error = true;
+					break;
+				}
+			}
+			ordered = true;
 		} else if (strcasecmp(argv[i], "-a") == 0
 				|| strcasecmp(argv[i], "--access") == 0) {
+			access = true;
 			i++;
 			if (i == argc) {
 				strncpy(errorString, "type of memory access pattern missing", errorStringSize);
@@ -270,6 +560,54 @@ int Experiment::parse_args(int argc, char* argv[]) {
 			}
 			if (strcasecmp(argv[i], "random") == 0) {
 				this->access_pattern = RANDOM;
+			} else if (strcasecmp(argv[i], "permute") == 0) {
+				this->access_pattern = PERMUTE;
+			} else if (strcasecmp(argv[i], "permute-pages") == 0) {
+				this->access_pattern = PERMUTE_PAGES;
+			} else if (strcasecmp(argv[i], "zipf") == 0) {
+				this->access_pattern = ZIPF;
+				i++;
+				if (i == argc) {
+					strncpy(errorString, "exponent of zipf memory access pattern missing", errorStringSize);
+					error = true;
+					break;
+				}
+				this->zipf_exponent = Experiment::parse_real(argv[i]);
+				if (this->zipf_exponent <= 0) {
+					strncpy(errorString, "invalid exponent of zipf memory access pattern", errorStringSize);
+					error = true;
+					break;
+				}
+			} else if (strcasecmp(argv[i], "hotcold") == 0) {
+				this->access_pattern = HOTCOLD;
+				i += 2;
+				if (argc <= i) {
+					strncpy(errorString, "hot fraction or share of hot/cold memory access pattern missing", errorStringSize);
+					error = true;
+					break;
+				}
+				this->hot_fraction = Experiment::parse_real(argv[i-1]);
+				this->hot_share = Experiment::parse_real(argv[i]);
+				if (this->hot_fraction <= 0 || 1 <= this->hot_fraction
+						|| this->hot_share < 0 || 1 < this->hot_share) {
+					strncpy(errorString, "invalid hot fraction or share of hot/cold memory access pattern", errorStringSize);
+					error = true;
+					break;
+				}
+			} else if (strcasecmp(argv[i], "window") == 0) {
+				this->access_pattern = WINDOW;
+				i++;
+				if (i == argc) {
+					strncpy(errorString, "size of windowed memory access pattern missing", errorStringSize);
+					error = true;
+					break;
+				}
+				this->bytes_per_window = Experiment::parse_number(argv[i]);
+				if (this->bytes_per_window <= 0) {
+					strncpy(errorString, "invalid size of windowed memory access pattern", errorStringSize);
+					error = true;
+					break;
+				}
 			} else if (strcasecmp(argv[i], "forward") == 0) {
 				this->access_pattern = STRIDED;
 				i++;
@@ -363,11 +701,40 @@ int Experiment::parse_args(int argc, char* argv[]) {
 					break;
 				}
 				this->placement_map = argv[i];
+			} else if (strcasecmp(argv[i], "cpuless") == 0) {
+				this->numa_placement = CPULESS;
+			} else if (strcasecmp(argv[i], "interleave") == 0) {
+				this->numa_placement = INTERLEAVE;
+				i++;
+				if (i == argc) {
+					strncpy(errorString, "numa placement interleave nodes missing", errorStringSize);
+					error = true;
+					break;
+				}
+				this->placement_map = argv[i];
 			} else {
 				snprintf(errorString, errorStringSize, "invalid numa placement -- '%s'", argv[i]);
 				error = true;
 				break;
 			}
+		} else if (strcasecmp(argv[i], "--mempolicy") == 0) {
+			i++;
+			if (i == argc) {
+				strncpy(errorString, "memory policy missing", errorStringSize);
+				error = true;
+				break;
+			}
+			if (strcasecmp(argv[i], "strict") == 0) {
+				this->numa_policy = POLICY_STRICT;
+			} else if (strcasecmp(argv[i], "preferred") == 0) {
+				this->numa_policy = POLICY_PREFERRED;
+			} else if (strcasecmp(argv[i], "interleave") == 0) {
+				this->numa_policy = POLICY_INTERLEAVE;
+			} else {
+				snprintf(errorString, errorStringSize, "invalid memory policy -- '%s'", argv[i]);
+				error = true;
+				break;
+			}
 		} else {
 			snprintf(errorString, errorStringSize, "invalid option -- '%s'", argv[i]);
 			error = true;
@@ -376,6 +743,161 @@ int Experiment::parse_args(int argc, char* argv[]) {
 	}
 
 
+	// page and line orders replace the access pattern, so
+	// the outcome must not depend on the order of options
+	if (!error && ordered) {
+		if (access) {
+			strncpy(errorString, "--page-order and --line-order cannot be combined with -a or --trace", errorStringSize);
+			error = true;
+		} else {
+			this->access_pattern = ORDERED;
+		}
+	}
+
+	// the gather engine needs AVX2 or AVX-512, and
+	// advances whole vectors of chains at once
+	if (!error && this->chase_engine == GATHER) {
+		AsmJit::CpuInfo* cpu = AsmJit::getCpuInfo();
+		if (cpu->extendedFeatures & AsmJit::CPU_EXTENDED_FEATURE_AVX512F) {
+			this->gather_width = 8;
+		} else if (cpu->extendedFeatures & AsmJit::CPU_EXTENDED_FEATURE_AVX2) {
+			this->gather_width = 4;
+		}
+
+		if (this->gather_width == 0) {
+			if (this->strict) {
+				strncpy(errorString, "gather engine not supported by this processor", errorStringSize);
+				error = true;
+			} else {
+				fprintf(stderr, "chase: gather engine not supported, using scalar engine\n");
+				this->chase_engine = SCALAR;
+			}
+		} else if (this->chains_per_thread % this->gather_width != 0) {
+			if (this->strict) {
+				snprintf(errorString, errorStringSize, "chains per thread must be a multiple of %lld for the gather engine", this->gather_width);
+				error = true;
+			} else {
+				this->chains_per_thread += this->gather_width - this->chains_per_thread % this->gather_width;
+			}
+		}
+		if (!error && MAX_GATHER_GROUPS * this->gather_width < this->chains_per_thread) {
+			snprintf(errorString, errorStringSize, "at most %lld chains per thread for the gather engine", MAX_GATHER_GROUPS * this->gather_width);
+			error = true;
+		}
+	}
+
+	// the native engine only has kernels for a
+	// limited set of chain counts and unroll factors
+	if (!error && this->chase_engine == NATIVE) {
+		if (Native::MAX_CHAINS < this->chains_per_thread) {
+			snprintf(errorString, errorStringSize, "at most %d chains per thread for the native engine", Native::MAX_CHAINS);
+			error = true;
+		} else if (Native::MAX_UNROLL < this->unroll
+				|| (this->unroll & (this->unroll - 1)) != 0) {
+			if (this->strict) {
+				snprintf(errorString, errorStringSize, "unroll factor must be a power of two up to %d for the native engine", Native::MAX_UNROLL);
+				error = true;
+			} else {
+				int64 unroll = 1;
+				while (unroll * 2 <= this->unroll && unroll * 2 <= Native::MAX_UNROLL)
+					unroll *= 2;
+				this->unroll = unroll;
+			}
+		}
+	}
+
+	// the payload word lives next to the link, and
+	// gathers have no store counterpart before AVX-512
+	if (!error && this->memory_operation != LOAD) {
+		if (this->bytes_per_line < 2 * this->pointer_size) {
+			strncpy(errorString, "cache line too small for a payload word", errorStringSize);
+			error = true;
+		} else if (this->chase_engine == GATHER) {
+			strncpy(errorString, "the gather engine only supports loads", errorStringSize);
+			error = true;
+		}
+	}
+
+	// the prefetching cursors are kept next to the chasing
+	// cursors in registers, by the scalar engine only
+	if (!error && (0 < this->prefetch_distance || this->prefetch_sweep)) {
+		if (this->chase_engine != SCALAR) {
+			strncpy(errorString, "prefetch distances require the scalar engine", errorStringSize);
+			error = true;
+		} else if (MAX_PREFETCH_CHAINS < this->chains_per_thread) {
+			snprintf(errorString, errorStringSize, "at most %d chains per thread with a prefetch distance", MAX_PREFETCH_CHAINS);
+			error = true;
+		} else if (this->prefetch_hint == NONE) {
+			if (this->strict) {
+				strncpy(errorString, "prefetch distance without prefetch hint", errorStringSize);
+				error = true;
+			} else {
+				this->prefetch_hint = T0;
+			}
+		}
+	}
+
+	// the rest of a node is read by the scalar engine only
+	if (!error && 0 < this->bytes_per_node && this->chase_engine != SCALAR) {
+		strncpy(errorString, "node sizes require the scalar engine", errorStringSize);
+		error = true;
+	}
+	if (!error && this->node_simd && this->bytes_per_node == 0) {
+		if (this->strict) {
+			strncpy(errorString, "SIMD node loads without node size", errorStringSize);
+			error = true;
+		} else {
+			this->node_simd = false;
+		}
+	}
+
+	// links elsewhere than at the start of the line need one
+	// link per line, and a payload word the kernel can find
+	if (!error && this->link_placement != LINK_FIRST) {
+		if (this->access_pattern == ZIPF || this->access_pattern == HOTCOLD
+				|| this->access_pattern == TRACE) {
+			snprintf(errorString, errorStringSize, "the %s pattern places its own links", this->access());
+			error = true;
+		} else if (0 < this->bytes_per_node) {
+			strncpy(errorString, "nodes start with their link", errorStringSize);
+			error = true;
+		} else if (this->chase_engine == NATIVE && this->memory_operation != LOAD) {
+			strncpy(errorString, "the native engine stores next to links at the start of the line", errorStringSize);
+			error = true;
+		}
+	}
+
+	// interleaving moves the pages the kernel faulted in one
+	// by one, which would split transparent huge pages
+	if (!error && this->numa_placement == INTERLEAVE && this->page_backing == PAGES_THP) {
+		strncpy(errorString, "interleaved numa placement cannot move transparent huge pages", errorStringSize);
+		error = true;
+	}
+
+	// the stream engine writes whole chains of its own,
+	// a line at a time with up to 16-byte aligned stores
+	if (!error && this->shared_chain && this->chase_engine == STREAM) {
+		strncpy(errorString, "the stream engine does not support a shared chain", errorStringSize);
+		error = true;
+	}
+	if (!error && this->chase_engine == STREAM && this->bytes_per_line % 16 != 0) {
+		strncpy(errorString, "the stream engine needs lines of a multiple of 16 bytes", errorStringSize);
+		error = true;
+	}
+
+	// the matrix places every run itself, with one chain
+	// for latency and many threads for bandwidth
+	if (!error && this->numa_matrix) {
+		if (this->numa_placement != LOCAL) {
+			strncpy(errorString, "the numa matrix places the chains itself", errorStringSize);
+			error = true;
+		} else if (this->shared_chain || this->prefetch_sweep
+				|| this->chase_engine == STREAM || this->chase_engine == GATHER) {
+			strncpy(errorString, "the numa matrix needs plain runs of the scalar or native engine", errorStringSize);
+			error = true;
+		}
+	}
+
 	// if we've hit an error, print a message and quit
 	if (error) {
 		printf("chase: %s\n", errorString);
@@ -396,20 +918,125 @@ int Experiment::parse_args(int argc, char* argv[]) {
 		printf("    [-t|--threads]     <number>    # number of threads (concurrency and contention)\n");
 		printf("    [-i|--iterations]  <number>    # iterations per experiment\n");
 		printf("    [-e|--experiments] <number>    # experiments\n");
+		printf("    [--engine]         <engine>    # code used to chase the chains\n");
+		printf("    [--op]             <operation> # operation performed on each line\n");
+		printf("    [--link]           <placement> # position of the link within its line\n");
 		printf("    [-a|--access]      <pattern>   # memory access pattern\n");
+		printf("    [--trace]          <file>      # replay the addresses recorded in <file>\n");
+		printf("    [--page-order]     <order>     # order of the pages within a chain\n");
+		printf("    [--line-order]     <order>     # order of the lines within a page\n");
 		printf("    [-o|--output]      <format>    # output format\n");
 		printf("    [-n|--numa]        <placement> # numa placement\n");
+		printf("    [--mempolicy]      <policy>    # numa memory policy of each chain\n");
+		printf("    [--numa-matrix]                # latency and bandwidth between all pairs of domains\n");
 		printf("    [-s|--seconds]     <number>    # run each experiment for <number> seconds\n");
 		printf("    [-g|--loop]        <number>    # cycles to execute for each iteration (latency hiding)\n");
+		printf("    [-u|--unroll]      <number>    # links chased per chain between loop tests\n");
+		printf("    [--node-size]      <number>    # bytes read by each hop, from 16 to 4096\n");
+		printf("    [--node-simd]                  # read nodes with 16-byte SIMD loads\n");
 		printf("    [-f|--prefetch]    <hint>      # use of prefetching\n");
+		printf("    [--prefetch-distance] <distance> # hops the prefetching cursor runs ahead\n");
 		printf("    [-x|--strict]                  # fail rather than adjust options to sensible values\n");
+		printf("    [--cold]                       # flush the chains from all caches before each iteration\n");
+		printf("    [--check]                      # verify every chain is a single cycle before measuring\n");
+		printf("    [--shared]                     # all threads build and chase a single chain of <chain> bytes\n");
+		printf("    [--pages]          <pages>     # pages backing the chains\n");
 		printf("\n");
 		printf("<pattern> is selected from the following:\n");
 		printf("    random                         # all chains are accessed randomly\n");
+		printf("    permute                        # uniform random cycle over all lines of a chain\n");
+		printf("    permute-pages                  # uniform random order of pages, then of lines\n");
+		printf("    window <size>                  # random within consecutive windows of <size> bytes\n");
+		printf("    zipf <s>                       # line popularity follows Zipf(<s>)\n");
+		printf("    hotcold <fraction> <share>     # <fraction> of the lines gets <share> of the visits\n");
 		printf("    forward <stride>               # chains are in forward order with constant stride\n");
 		printf("    reverse <stride>               # chains are in reverse order with constant stride\n");
 		printf("\n");
 		printf("Note: <stride> is always a small positive integer.\n");
+		printf("The random pattern visits pages and lines in an affine order, which\n");
+		printf("some prefetchers learn; the permute patterns draw every order uniformly.\n");
+		printf("The window pattern visits the lines of each window of <size> bytes in\n");
+		printf("uniform random order before moving on to the next window; <size> is\n");
+		printf("rounded up to whole lines and sets the reuse distance, from strided\n");
+		printf("(one line) to random (the whole chain).\n");
+		printf("The zipf and hotcold patterns draw as many visits as the chain has lines\n");
+		printf("from a skewed popularity and chase them in random order, so hot lines\n");
+		printf("recur within an iteration and rarely visited lines may be left out.\n");
+		printf("Every visit needs a link of its own in the line, which caps a line at\n");
+		printf("one visit per link (half of them for store and rmw); the visits beyond\n");
+		printf("the cap go to the other lines in proportion to their popularity, or -x\n");
+		printf("fails. The effective hot share reports the visits that went to the hot\n");
+		printf("lines for hotcold, and to the capped lines for zipf.\n");
+		printf("\n");
+		printf("<order> is selected from the following:\n");
+		printf("    sequential                     # ascending order (default)\n");
+		printf("    reverse                        # descending order\n");
+		printf("    strided <stride>               # every <stride>th one, then those after them\n");
+		printf("    random                         # uniform random order, drawn anew for every page\n");
+		printf("\n");
+		printf("Note: --page-order and --line-order replace the access pattern, so\n");
+		printf("they cannot be combined with -a or --trace, and order pages and the\n");
+		printf("lines within each page independently.\n");
+		printf("\n");
+		printf("A trace is either text with one hexadecimal address per line, as printed\n");
+		printf("by \"perf script -F addr\", or binary 64-bit little-endian addresses.\n");
+		printf("Addresses are taken relative to the lowest one, wrap around the chain\n");
+		printf("(an error in strict mode), and are chased in recorded order. A line\n");
+		printf("holds one visit per link (half of them for store and rmw), and visits\n");
+		printf("beyond that are skipped and counted (an error in strict mode).\n");
+		printf("\n");
+		printf("<engine> is selected from the following:\n");
+		printf("    scalar                         # one load per chain and hop (default)\n");
+		printf("    gather                         # one AVX2/AVX-512 gather per 4/8 chains and hop\n");
+		printf("    native                         # compiled C++ kernels, for hosts that forbid JIT code\n");
+		printf("    stream                         # store bandwidth of regular, non-temporal and rep stosb\n");
+		printf("                                   # stores over the chain memory, instead of chasing\n");
+		printf("\n");
+		printf("Note: the gather engine ignores prefetch hints, rounds the chains per\n");
+		printf("thread up to a whole vector and falls back to scalar when unsupported.\n");
+		printf("The native engine supports up to 16 chains per thread, and rounds the\n");
+		printf("unroll factor down to a power of two up to 16. The stream engine needs\n");
+		printf("lines of a multiple of 16 bytes.\n");
+		printf("\n");
+		printf("<operation> is selected from the following:\n");
+		printf("    load                           # only load the link (default)\n");
+		printf("    store                          # also store a payload word in the same line\n");
+		printf("    rmw                            # also increment a payload word in the same line\n");
+		printf("\n");
+		printf("Note: store and rmw dirty every line, which has to be written back.\n");
+		printf("Bandwidth counts the cache lines each hop loads, two for split links,\n");
+		printf("and the write-back the cache lines its payload dirties.\n");
+		printf("\n");
+		printf("<placement> is selected from the following:\n");
+		printf("    first                          # first word of the line (default)\n");
+		printf("    last                           # last word of the line\n");
+		printf("    random                         # a random word of each line\n");
+		printf("    split-line                     # straddling the end of the line\n");
+		printf("    split-page                     # straddling the end of a page, one link per page\n");
+		printf("\n");
+		printf("Note: the payload of store and rmw is the word after the link, or the\n");
+		printf("word before it when the link ends the line; random then only uses every\n");
+		printf("other word. Skewed and trace patterns, and nodes, keep links first.\n");
+		printf("\n");
+		printf("A node takes the place of a line in the chain, overriding the line size.\n");
+		printf("Every hop reads one word of each cache line of its node, or the whole\n");
+		printf("node with --node-simd, next to following the link. Nodes require the\n");
+		printf("scalar engine.\n");
+		printf("\n");
+		printf("With --shared the chain is split into one segment per chain of every\n");
+		printf("thread. Each thread builds its own segments in parallel, the segments\n");
+		printf("are stitched into one cycle, and every chain starts in its own segment.\n");
+		printf("\n");
+		printf("<pages> is selected from the following:\n");
+		printf("    default                        # whatever the system decides (default)\n");
+		printf("    4k                             # base pages, transparent huge pages disabled\n");
+		printf("    thp                            # transparent huge pages, if the kernel obliges\n");
+		printf("    2m                             # 2 MB pages from the hugetlb pool\n");
+		printf("    1g                             # 1 GB pages from the hugetlb pool\n");
+		printf("\n");
+		printf("Note: 2m and 1g need enough free pages in the pool, which is set through\n");
+		printf("/sys/kernel/mm/hugepages. The page size actually obtained is read back\n");
+		printf("from /proc/self/smaps and reported, along with the share of huge pages.\n");
 		printf("\n");
 		printf("<format> is selected from the following:\n");
 		printf("    hdr                            # csv header only\n");
@@ -424,11 +1051,23 @@ int Experiment::parse_args(int argc, char* argv[]) {
 		printf("    t1                             # use the T1 hint (prefetch into all caches except L1)\n");
 		printf("    t2                             # use the T2 hint (prefetch into all caches except L1 & L2)\n");
 		printf("\n");
+		printf("<distance> is selected from the following:\n");
+		printf("    <number>                       # prefetch <number> hops ahead of each chain (0..64)\n");
+		printf("    sweep                          # measure distances 0, 1, 2, 4, ... up to 64\n");
+		printf("\n");
+		printf("Note: a prefetch distance follows every chain with a second cursor\n");
+		printf("that many hops ahead, and prefetches its target. It requires the scalar\n");
+		printf("engine and at most 6 chains per thread, and defaults to the T0 hint.\n");
+		printf("Sweep the distance at chain sizes matching each cache level and memory\n");
+		printf("to find the best distance per tier.\n");
+		printf("\n");
 		printf("<placement> is selected from the following:\n");
 		printf("    local                          # all chains are allocated locally\n");
 		printf("    xor <mask>                     # exclusive OR and mask\n");
 		printf("    add <offset>                   # addition and offset\n");
 		printf("    map <map>                      # explicit mapping of threads and chains to domains\n");
+		printf("    interleave <nodes>             # pages of every chain spread across domains\n");
+		printf("    cpuless                        # chains on domains with memory but no cpus\n");
 		printf("\n");
 		printf("<map> has the form \"t1:c11,c12,...,c1m;t2:c21,...,c2m;...;tn:cn1,...,cnm\"\n");
 		printf("where t[i] is the NUMA domain where the ith thread is run,\n");
@@ -441,6 +1080,35 @@ int Experiment::parse_args(int argc, char* argv[]) {
 		printf("thread or chain domains that exceed the maximum NUMA domain\n");
 		printf("are wrapped around using a MOD function.\n");
 		printf("\n");
+		printf("Note: threads only run on domains with cpus, taken in turn, while\n");
+		printf("chains may be placed on any domain, including memory-only domains such\n");
+		printf("as CXL expanders. cpuless spreads the chains of every thread across\n");
+		printf("those, and xor and add pick the domain among those with memory, wrapped\n");
+		printf("around their count. Results report the memory tier of the chains: local,\n");
+		printf("remote (another domain with cpus), cpu-less, or mixed.\n");
+		printf("\n");
+		printf("<nodes> has the form \"n1[:w1],n2[:w2],...,nk[:wk]\" where n[i] is a NUMA\n");
+		printf("domain and w[i] the number of consecutive pages it takes in turn (1 by\n");
+		printf("default, at most %d), so \"0,1\" is round-robin and \"0:3,1:1\" puts 3 of\n", MAX_INTERLEAVE_WEIGHT);
+		printf("every 4 pages on domain 0. Threads are placed as for local, and every page\n");
+		printf("is moved to its domain after the chain is faulted in, regardless of\n");
+		printf("<policy>. Pages are 4 KB or hugetlb pages; thp cannot be interleaved.\n");
+		printf("\n");
+		printf("<policy> is selected from the following:\n");
+		printf("    strict                         # only the domain of the chain (default)\n");
+		printf("    preferred                      # the domain of the chain, others once it is full\n");
+		printf("    interleave                     # all domains with memory, page by page\n");
+		printf("\n");
+		printf("Note: every chain is mapped and bound to its domain on its own, and\n");
+		printf("all threads fault their chains in parallel before building them.\n");
+		printf("The domain of every page is then verified, and the pages found\n");
+		printf("outside the domains of their policy are reported as misplaced.\n");
+		printf("\n");
+		printf("With --numa-matrix every pair of a cpu domain and a memory domain is\n");
+		printf("measured in turn, once with a single thread and chain for latency, and\n");
+		printf("once with <threads> threads of <references> chains for bandwidth. When\n");
+		printf("<threads> is 1, the bandwidth runs use one thread per cpu of the domain.\n");
+		printf("\n");
 		printf("To determine the number of NUMA domains currently available\n");
 		printf("on your system, use a command such as \"numastat\".\n");
 		printf("\n");
@@ -453,19 +1121,42 @@ int Experiment::parse_args(int argc, char* argv[]) {
 
 	// STRICT -- fail if specifications are inconsistent
 
+	// nodes replace lines as the unit of the chain
+	if (0 < this->bytes_per_node) {
+		this->bytes_per_line = this->bytes_per_node;
+	}
+
+	// links straddling pages take a page each,
+	// while bandwidth still counts cache lines
+	this->bytes_per_stride = this->bytes_per_line;
+	if (this->link_placement == LINK_SPLIT_PAGE) {
+		this->bytes_per_stride = this->bytes_per_page;
+	}
+
+	// the payload stays within the line of its link
+	if (this->link_placement == LINK_FIRST || this->link_placement == LINK_RANDOM) {
+		this->payload_offset = this->pointer_size;
+	} else {
+		this->payload_offset = -this->pointer_size;
+	}
+
 	// compute lines per page and lines per chain
 	// based on input and defaults.
 	// we round up page and chain sizes when needed.
-	this->lines_per_page   = (this->bytes_per_page+this->bytes_per_line-1) / this->bytes_per_line;
-	this->bytes_per_page   = this->bytes_per_line * this->lines_per_page;
+	this->lines_per_page   = (this->bytes_per_page+this->bytes_per_stride-1) / this->bytes_per_stride;
+	this->bytes_per_page   = this->bytes_per_stride * this->lines_per_page;
 	this->pages_per_chain  = (this->bytes_per_chain+this->bytes_per_page-1) / this->bytes_per_page;
 	this->bytes_per_chain  = this->bytes_per_page * this->pages_per_chain;
 	this->bytes_per_thread = this->bytes_per_chain * this->chains_per_thread;
 	this->bytes_per_test   = this->bytes_per_thread * this->num_threads;
-	this->links_per_line   = this->bytes_per_line / pointer_size;
+	this->links_per_line   = this->bytes_per_stride / pointer_size;
 	this->links_per_page   = this->lines_per_page * this->links_per_line;
 	this->lines_per_chain  = this->lines_per_page * this->pages_per_chain;
 	this->links_per_chain  = this->lines_per_chain * this->links_per_line;
+	this->pages_per_segment = this->pages_per_chain;
+	if (this->access_pattern == WINDOW) {
+		this->bytes_per_window = (this->bytes_per_window+this->bytes_per_stride-1) / this->bytes_per_stride * this->bytes_per_stride;
+	}
 
 
 	// allocate the chain roots for all threads
@@ -475,17 +1166,13 @@ int Experiment::parse_args(int argc, char* argv[]) {
 	case LOCAL:
 	case XOR:
 	case ADD:
+	case INTERLEAVE:
+	case CPULESS:
 		this->thread_domain = new int32[this->num_threads];
 		this->chain_domain = new int32*[this->num_threads];
-		this->random_state = new char*[this->num_threads];
 
 		for (int i = 0; i < this->num_threads; i++) {
 			this->chain_domain[i] = new int32[this->chains_per_thread];
-
-			const int state_size = 256;
-			this->random_state[i] = new char[state_size];
-			initstate((unsigned int) i, (char *) this->random_state[i],
-					(size_t) state_size);
 		}
 		break;
 	}
@@ -494,6 +1181,20 @@ int Experiment::parse_args(int argc, char* argv[]) {
 	this->numa_max_domain = numa_max_node();
 	this->num_numa_domains = this->numa_max_domain + 1;
 #endif
+	this->discover_domains();
+
+	// memory-only domains must exist to place chains on them
+	if (this->numa_placement == CPULESS) {
+		int cpuless = 0;
+		for (int i = 0; i < this->num_memory_domains; i++) {
+			if (!this->has_cpus(this->memory_domains[i]))
+				cpuless++;
+		}
+		if (cpuless == 0) {
+			printf("chase: no domains with memory but no cpus\n");
+			return 1;
+		}
+	}
 
 	switch (this->numa_placement) {
 	case LOCAL:
@@ -509,11 +1210,259 @@ int Experiment::parse_args(int argc, char* argv[]) {
 	case MAP:
 		this->alloc_map();
 		break;
+	case INTERLEAVE:
+		this->alloc_interleave();
+		break;
+	case CPULESS:
+		this->alloc_cpuless();
+		break;
+	}
+
+	// a shared chain is split into one segment per chain
+	// of every thread, which is only known after placement
+	if (this->shared_chain) {
+		int64 segments = this->num_threads * this->chains_per_thread;
+		if (this->pages_per_chain % segments != 0) {
+			if (this->strict) {
+				printf("chase: shared chain must be a multiple of %lld pages\n", segments);
+				return 1;
+			}
+			this->pages_per_chain += segments - this->pages_per_chain % segments;
+			this->bytes_per_chain  = this->bytes_per_page * this->pages_per_chain;
+			this->lines_per_chain  = this->lines_per_page * this->pages_per_chain;
+			this->links_per_chain  = this->lines_per_chain * this->links_per_line;
+		}
+		this->pages_per_segment = this->pages_per_chain / segments;
+		this->bytes_per_test    = this->bytes_per_chain;
+		this->bytes_per_thread  = this->bytes_per_test / this->num_threads;
+	}
+
+	// pages of the hugetlb pool cannot be overcommitted,
+	// so running out of them is better caught up front
+	int64 free_pages = Memory::free_pages(this->page_backing);
+	if (0 <= free_pages) {
+		int64 bytes = (this->links_per_chain + this->links_per_line) * sizeof(Chain);
+		int64 chains = this->shared_chain ? 1 : this->num_threads * this->chains_per_thread;
+		int64 pages = chains * Memory::mapped(bytes, this->page_backing) / Memory::page_size(this->page_backing);
+		if (free_pages < pages) {
+			printf("chase: %lld %s pages needed, %lld free\n", pages, this->backing(), free_pages);
+			return 1;
+		}
+	}
+
+	// read the trace once, for all threads
+	if (this->access_pattern == TRACE && this->load_trace()) {
+		return 1;
+	}
+
+	// skewed chains all have the same visits, in their own order
+	if ((this->access_pattern == ZIPF || this->access_pattern == HOTCOLD)
+			&& this->count_visits()) {
+		return 1;
+	}
+
+	// maps dictate the amount of chains, which
+	// cannot be rounded up to a whole vector
+	if (this->chase_engine == GATHER
+			&& (this->chains_per_thread % this->gather_width != 0
+				|| MAX_GATHER_GROUPS * this->gather_width < this->chains_per_thread)) {
+		printf("chase: map does not fit the %lld-wide gather engine\n", this->gather_width);
+		return 1;
+	}
+
+	return 0;
+}
+
+int Experiment::load_trace() {
+	FILE* f = fopen(this->trace_file, "rb");
+	if (f == NULL) {
+		printf("chase: cannot open trace file -- '%s'\n", this->trace_file);
+		return 1;
+	}
+
+	// text traces never contain a NUL byte,
+	// while 64-bit addresses nearly always do
+	char head[4096];
+	size_t n = fread(head, 1, sizeof head, f);
+	bool binary = memchr(head, 0, n) != NULL;
+	rewind(f);
+
+	std::vector<uint64> addresses;
+	if (binary) {
+		uint64 a;
+		while (fread(&a, sizeof a, 1, f) == 1)
+			addresses.push_back(a);
+	} else {
+		char line[256];
+		while (fgets(line, sizeof line, f) != NULL) {
+			char* p = line + strspn(line, " \t");
+			char* end;
+			uint64 a = strtoull(p, &end, 16);
+			if (end != p && *p != '#')
+				addresses.push_back(a);
+		}
+	}
+	fclose(f);
+
+	if (addresses.empty()) {
+		printf("chase: no addresses in trace file -- '%s'\n", this->trace_file);
+		return 1;
+	}
+
+	// make the addresses relative to the lowest one
+	uint64 lowest = *std::min_element(addresses.begin(), addresses.end());
+	int64 lines = this->pages_per_segment * this->lines_per_page;
+	this->trace_length = addresses.size();
+	this->trace = new int64[this->trace_length];
+	int64 span = 0;
+	for (int64 i = 0; i < this->trace_length; i++) {
+		this->trace[i] = (addresses[i] - lowest) / this->bytes_per_stride;
+		span = std::max(span, this->trace[i] + 1);
+	}
+
+	if (lines < span) {
+		if (this->strict) {
+			printf("chase: trace spans %lld bytes, more than a chain\n", span * this->bytes_per_stride);
+			return 1;
+		}
+		fprintf(stderr, "chase: trace spans %lld bytes, wrapping it around the chain\n", span * this->bytes_per_stride);
+	}
+
+	// every visit needs a link of its own within its line,
+	// so drop the visits to lines whose links are all taken
+	int64 step = (this->memory_operation == LOAD) ? 1 : 2;
+	int64 slots = this->links_per_line / step;
+	std::vector<int32> visits(lines);
+	int64 kept = 0;
+	for (int64 i = 0; i < this->trace_length; i++) {
+		int64 line = this->trace[i] % lines;
+		if (visits[line] == slots)
+			continue;
+		visits[line] += 1;
+		this->trace[kept++] = line;
+	}
+	this->trace_skipped = this->trace_length - kept;
+	this->trace_length = kept;
+
+	if (0 < this->trace_skipped) {
+		if (this->strict) {
+			printf("chase: %lld trace visits find no link left in their line\n", this->trace_skipped);
+			return 1;
+		}
+		fprintf(stderr, "chase: skipped %lld of %lld trace visits, their lines have no links left\n",
+				this->trace_skipped, this->trace_length + this->trace_skipped);
 	}
 
 	return 0;
 }
 
+// divide as many visits as a chain has lines among its lines,
+// by popularity rank. a line holds at most one visit per link,
+// so the mass beyond that is spread over the other lines in
+// proportion to their popularity, and the visits are rounded
+// by largest remainder, so every chain gets exactly as many.
+int Experiment::count_visits() {
+	int64 lines = this->pages_per_segment * this->lines_per_page;
+	int64 step = (this->memory_operation == LOAD) ? 1 : 2;
+	int64 slots = this->links_per_line / step;
+	int64 hot = std::max((int64) 1, (int64) (this->hot_fraction * lines));
+
+	// expected visits of each rank
+	std::vector<double> expected(lines);
+	double norm = 0;
+	for (int64 r = 0; r < lines; r++) {
+		if (this->access_pattern == ZIPF) {
+			expected[r] = pow(r + 1, -this->zipf_exponent);
+		} else if (r < hot) {
+			expected[r] = this->hot_share / hot;
+		} else {
+			expected[r] = (1 - this->hot_share) / std::max((int64) 1, lines - hot);
+		}
+		norm += expected[r];
+	}
+	for (int64 r = 0; r < lines; r++)
+		expected[r] *= lines / norm;
+
+	// cap the lines with too many visits and spread the
+	// excess over the others, until no other line overflows
+	std::vector<double> requested(expected);
+	std::vector<bool> full(lines, false);
+	int64 capped = 0;
+	bool overflow = true;
+	while (overflow) {
+		overflow = false;
+		double rest = 0;
+		for (int64 r = 0; r < lines; r++) {
+			if (full[r]) continue;
+			if (slots < expected[r]) {
+				expected[r] = slots;
+				full[r] = true;
+				capped++;
+				overflow = true;
+			} else {
+				rest += expected[r];
+			}
+		}
+		double left = lines - (double) capped * slots;
+		for (int64 r = 0; overflow && r < lines && 0 < rest; r++)
+			if (!full[r])
+				expected[r] *= left / rest;
+	}
+
+	// round by largest remainder
+	this->visits = new int32[lines];
+	std::vector<std::pair<double, int64> > remainders(lines);
+	int64 total = 0;
+	for (int64 r = 0; r < lines; r++) {
+		this->visits[r] = std::min(slots, (int64) expected[r]);
+		total += this->visits[r];
+		remainders[r] = std::make_pair(this->visits[r] - expected[r], r);
+	}
+	std::sort(remainders.begin(), remainders.end());
+	for (int64 k = 0; total < lines; k++) {
+		this->visits[remainders[k].second] += 1;
+		total++;
+	}
+
+	// share of the visits that went to the hot lines, or
+	// to the capped lines, which zipf has instead
+	int64 share = 0;
+	double wanted = 0;
+	for (int64 r = 0; r < lines; r++) {
+		if (full[r])
+			wanted += requested[r];
+		if (this->access_pattern == ZIPF ? full[r] : r < hot)
+			share += this->visits[r];
+	}
+	this->capped_lines = capped;
+	this->effective_share = (float) share / lines;
+
+	if (0 < capped) {
+		if (this->strict) {
+			printf("chase: %lld lines need more visits than their %lld links\n", capped, slots);
+			return 1;
+		}
+		fprintf(stderr, "chase: %lld lines capped at %lld visits, their share drops from %.3f to %.3f\n",
+				capped, slots, wanted / lines, (double) capped * slots / lines);
+	}
+
+	return 0;
+}
+
+int32 Experiment::parse_order(const char* s) {
+	if (strcasecmp(s, "sequential") == 0) {
+		return ORDER_SEQUENTIAL;
+	} else if (strcasecmp(s, "reverse") == 0) {
+		return ORDER_REVERSE;
+	} else if (strcasecmp(s, "strided") == 0) {
+		return ORDER_STRIDED;
+	} else if (strcasecmp(s, "random") == 0) {
+		return ORDER_RANDOM;
+	}
+
+	return -1;
+}
+
 int64 Experiment::parse_number(const char* s) {
 	int64 result = 0;
 
@@ -565,9 +1514,44 @@ float Experiment::parse_real(const char* s) {
 	return result;
 }
 
+// find the domains with cpus and the domains with memory.
+// memory-only domains, such as CXL expanders, cannot run
+// threads, and domains may be missing from the range.
+void Experiment::discover_domains() {
+	std::vector<int32> cpus, memory;
+#if defined(NUMA)
+	for (int32 d = 0; d < this->num_numa_domains; d++) {
+		if (0 < this->domain_cpus(d)) {
+			cpus.push_back(d);
+		}
+		if (0 < numa_node_size64(d, NULL)) {
+			memory.push_back(d);
+		}
+	}
+#endif
+	if (cpus.empty()) {
+		cpus.push_back(0);
+	}
+	if (memory.empty()) {
+		memory.push_back(0);
+	}
+
+	this->num_cpu_domains = cpus.size();
+	this->cpu_domains = new int32[this->num_cpu_domains];
+	std::copy(cpus.begin(), cpus.end(), this->cpu_domains);
+	this->num_memory_domains = memory.size();
+	this->memory_domains = new int32[this->num_memory_domains];
+	std::copy(memory.begin(), memory.end(), this->memory_domains);
+}
+
+bool Experiment::has_cpus(int32 domain) {
+	return std::find(this->cpu_domains, this->cpu_domains + this->num_cpu_domains,
+			domain) != this->cpu_domains + this->num_cpu_domains;
+}
+
 void Experiment::alloc_local() {
 	for (int i = 0; i < this->num_threads; i++) {
-		this->thread_domain[i] = i % this->num_numa_domains;
+		this->thread_domain[i] = this->cpu_domains[i % this->num_cpu_domains];
 		for (int j = 0; j < this->chains_per_thread; j++) {
 			this->chain_domain[i][j] = this->thread_domain[i];
 		}
@@ -576,20 +1560,20 @@ void Experiment::alloc_local() {
 
 void Experiment::alloc_xor() {
 	for (int i = 0; i < this->num_threads; i++) {
-		this->thread_domain[i] = i % this->num_numa_domains;
+		this->thread_domain[i] = this->cpu_domains[i % this->num_cpu_domains];
 		for (int j = 0; j < this->chains_per_thread; j++) {
-			this->chain_domain[i][j] = (this->thread_domain[i]
-					^ this->offset_or_mask) % this->num_numa_domains;
+			this->chain_domain[i][j] = this->memory_domains[(this->thread_domain[i]
+					^ this->offset_or_mask) % this->num_memory_domains];
 		}
 	}
 }
 
 void Experiment::alloc_add() {
 	for (int i = 0; i < this->num_threads; i++) {
-		this->thread_domain[i] = i % this->num_numa_domains;
+		this->thread_domain[i] = this->cpu_domains[i % this->num_cpu_domains];
 		for (int j = 0; j < this->chains_per_thread; j++) {
-			this->chain_domain[i][j] = (this->thread_domain[i]
-					+ this->offset_or_mask) % this->num_numa_domains;
+			this->chain_domain[i][j] = this->memory_domains[(this->thread_domain[i]
+					+ this->offset_or_mask) % this->num_memory_domains];
 		}
 	}
 }
@@ -677,15 +1661,13 @@ void Experiment::alloc_map() {
 
 	this->thread_domain = new int32[this->num_threads];
 	this->chain_domain = new int32*[this->num_threads];
-	this->random_state = new char*[this->num_threads];
 
 	for (int i = 0; i < this->num_threads; i++) {
 		this->thread_domain[i] = thread_domain[i] % this->num_numa_domains;
-
-		const int state_size = 256;
-		this->random_state[i] = new char[state_size];
-		initstate((unsigned int) i, (char *) this->random_state[i],
-				(size_t) state_size);
+		if (!this->has_cpus(this->thread_domain[i])) {
+			fprintf(stderr, "Domain %d has no cpus.\n", this->thread_domain[i]);
+			exit(1);
+		}
 
 		this->chain_domain[i] = new int32[this->chains_per_thread];
 		for (int j = 0; j < this->chains_per_thread; j++) {
@@ -698,35 +1680,187 @@ void Experiment::alloc_map() {
 	this->bytes_per_test = this->bytes_per_thread * this->num_threads;
 }
 
+// threads run on the domains with cpus, and their
+// chains are spread across the domains without
+void Experiment::alloc_cpuless() {
+	std::vector<int32> cpuless;
+	for (int i = 0; i < this->num_memory_domains; i++) {
+		if (!this->has_cpus(this->memory_domains[i])) {
+			cpuless.push_back(this->memory_domains[i]);
+		}
+	}
+
+	for (int i = 0; i < this->num_threads; i++) {
+		this->thread_domain[i] = this->cpu_domains[i % this->num_cpu_domains];
+		for (int j = 0; j < this->chains_per_thread; j++) {
+			this->chain_domain[i][j] = cpuless[(i * this->chains_per_thread + j) % cpuless.size()];
+		}
+	}
+}
+
+// all threads run on one domain, and all
+// chains are allocated on one domain
+void Experiment::alloc_pair(int32 cpu_domain, int32 memory_domain, int64 threads, int64 chains) {
+	for (int i = 0; i < this->num_threads; i++) {
+		delete[] this->chain_domain[i];
+	}
+	delete[] this->chain_domain;
+	delete[] this->thread_domain;
+
+	this->num_threads = threads;
+	this->chains_per_thread = chains;
+	this->thread_domain = new int32[this->num_threads];
+	this->chain_domain = new int32*[this->num_threads];
+	for (int i = 0; i < this->num_threads; i++) {
+		this->thread_domain[i] = cpu_domain;
+		this->chain_domain[i] = new int32[this->chains_per_thread];
+		for (int j = 0; j < this->chains_per_thread; j++) {
+			this->chain_domain[i][j] = memory_domain;
+		}
+	}
+
+	this->bytes_per_thread = this->bytes_per_chain * this->chains_per_thread;
+	this->bytes_per_test = this->bytes_per_thread * this->num_threads;
+	this->pages_checked = 0;
+	this->pages_misplaced = 0;
+}
+
+// number of cpus of a domain, or an even
+// share of all cpus without numa support
+int64 Experiment::domain_cpus(int32 domain) {
+	int64 cpus = 0;
+#if defined(NUMA)
+	struct bitmask* mask = numa_allocate_cpumask();
+	if (numa_node_to_cpus(domain, mask) == 0) {
+		cpus = numa_bitmask_weight(mask);
+	}
+	numa_free_cpumask(mask);
+#else
+	cpus = sysconf(_SC_NPROCESSORS_ONLN) / this->num_numa_domains;
+#endif
+	return cpus;
+}
+
+// interleave lists look like "n1[:w1],n2[:w2],...,nk[:wk]"
+// where n[i] is a domain and w[i] the pages it takes in turn
+void Experiment::alloc_interleave() {
+	std::vector<int32> nodes;
+	char *p = this->placement_map;
+	while (true) {
+		char *q;
+		long node = strtol(p, &q, 10);
+		long weight = 1;
+		if (q == p || node < 0) {
+			fprintf(stderr, "Malformed node list.\n");
+			exit(1);
+		}
+		p = q;
+		if (*p == ':') {
+			p++;
+			weight = strtol(p, &q, 10);
+			if (q == p || weight < 1) {
+				fprintf(stderr, "Malformed node list.\n");
+				exit(1);
+			}
+			if (MAX_INTERLEAVE_WEIGHT < weight) {
+				fprintf(stderr, "Node weights must be at most %d.\n", MAX_INTERLEAVE_WEIGHT);
+				exit(1);
+			}
+			p = q;
+		}
+		for (long w = 0; w < weight; w++) {
+			nodes.push_back(node % this->num_numa_domains);
+		}
+
+		if (*p == '\0')
+			break;
+		if (*p != ',') {
+			fprintf(stderr, "Malformed node list.\n");
+			exit(1);
+		}
+		p++;
+	}
+
+	this->interleave_length = nodes.size();
+	this->interleave_nodes = new int32[this->interleave_length];
+	std::copy(nodes.begin(), nodes.end(), this->interleave_nodes);
+
+	// chains start out on the first domain of the list
+	for (int i = 0; i < this->num_threads; i++) {
+		this->thread_domain[i] = this->cpu_domains[i % this->num_cpu_domains];
+		for (int j = 0; j < this->chains_per_thread; j++) {
+			this->chain_domain[i][j] = this->interleave_nodes[0];
+		}
+	}
+}
+
 void Experiment::print() {
 	printf("strict            = %s\n", strict?"yes":"no");
-	printf("pointer_size      = %d\n", pointer_size);
-	printf("sizeof(Chain)     = %d\n", sizeof(Chain));
-	printf("sizeof(Chain *)   = %d\n", sizeof(Chain *));
-	printf("bytes_per_line    = %d\n", bytes_per_line);
-	printf("links_per_line    = %d\n", links_per_line);
-	printf("bytes_per_page    = %d\n", bytes_per_page);
-	printf("lines_per_page    = %d\n", lines_per_page);
-	printf("links_per_page    = %d\n", links_per_page);
-	printf("bytes_per_chain   = %d\n", bytes_per_chain);
-	printf("lines_per_chain   = %d\n", lines_per_chain);
-	printf("links_per_chain   = %d\n", links_per_chain);
-	printf("pages_per_chain   = %d\n", pages_per_chain);
-	printf("chains_per_thread = %d\n", chains_per_thread);
-	printf("bytes_per_thread  = %d\n", bytes_per_thread);
-	printf("num_threads       = %d\n", num_threads);
-	printf("bytes_per_test    = %d\n", bytes_per_test);
-	printf("loop length       = %d\n", loop_length);
+	printf("cold              = %s\n", cold?"yes":"no");
+	printf("check             = %s\n", check?"yes":"no");
+	printf("shared_chain      = %s\n", shared_chain?"yes":"no");
+	printf("page_backing      = %d\n", page_backing);
+	printf("backing_page_size = %lld\n", backing_page_size);
+	printf("huge_page_share   = %f\n", huge_page_share);
+	printf("pointer_size      = %lld\n", pointer_size);
+	printf("sizeof(Chain)     = %zu\n", sizeof(Chain));
+	printf("sizeof(Chain *)   = %zu\n", sizeof(Chain *));
+	printf("bytes_per_line    = %lld\n", bytes_per_line);
+	printf("bytes_per_stride  = %lld\n", bytes_per_stride);
+	printf("links_per_line    = %lld\n", links_per_line);
+	printf("bytes_per_page    = %lld\n", bytes_per_page);
+	printf("lines_per_page    = %lld\n", lines_per_page);
+	printf("links_per_page    = %lld\n", links_per_page);
+	printf("bytes_per_chain   = %lld\n", bytes_per_chain);
+	printf("lines_per_chain   = %lld\n", lines_per_chain);
+	printf("links_per_chain   = %lld\n", links_per_chain);
+	printf("pages_per_chain   = %lld\n", pages_per_chain);
+	printf("pages_per_segment = %lld\n", pages_per_segment);
+	printf("chains_per_thread = %lld\n", chains_per_thread);
+	printf("bytes_per_thread  = %lld\n", bytes_per_thread);
+	printf("num_threads       = %lld\n", num_threads);
+	printf("bytes_per_test    = %lld\n", bytes_per_test);
+	printf("loop length       = %lld\n", loop_length);
+	printf("unroll            = %lld\n", unroll);
+	printf("bytes_per_node    = %lld\n", bytes_per_node);
+	printf("node_simd         = %s\n", node_simd?"yes":"no");
 	printf("prefetch hint     = %s\n", prefetch_hint_string(prefetch_hint));
-	printf("iterations        = %d\n", iterations);
-	printf("experiments       = %d\n", experiments);
+	printf("prefetch_distance = %lld\n", prefetch_distance);
+	printf("prefetch_sweep    = %s\n", prefetch_sweep?"yes":"no");
+	printf("chase_engine      = %d\n", chase_engine);
+	printf("gather_width      = %lld\n", gather_width);
+	printf("memory_operation  = %d\n", memory_operation);
+	printf("payload_offset    = %lld\n", payload_offset);
+	printf("link_placement    = %d\n", link_placement);
+	printf("iterations        = %lld\n", iterations);
+	printf("experiments       = %lld\n", experiments);
 	printf("access_pattern    = %d\n", access_pattern);
-	printf("stride            = %d\n", stride);
+	printf("stride            = %lld\n", stride);
+	printf("bytes_per_window  = %lld\n", bytes_per_window);
+	printf("zipf_exponent     = %f\n", zipf_exponent);
+	printf("hot_fraction      = %f\n", hot_fraction);
+	printf("hot_share         = %f\n", hot_share);
+	printf("capped_lines      = %lld\n", capped_lines);
+	printf("effective_share   = %f\n", effective_share);
+	printf("trace_file        = %s\n", trace_file ? trace_file : "");
+	printf("trace_length      = %lld\n", trace_length);
+	printf("trace_skipped     = %lld\n", trace_skipped);
+	printf("page_order        = %d\n", page_order);
+	printf("page_stride       = %lld\n", page_stride);
+	printf("line_order        = %d\n", line_order);
+	printf("line_stride       = %lld\n", line_stride);
 	printf("output_mode       = %d\n", output_mode);
 	printf("numa_placement    = %d\n", numa_placement);
-	printf("offset_or_mask    = %d\n", offset_or_mask);
+	printf("offset_or_mask    = %lld\n", offset_or_mask);
+	printf("interleave_length = %lld\n", interleave_length);
+	printf("numa_policy       = %d\n", numa_policy);
+	printf("pages_checked     = %lld\n", pages_checked);
+	printf("pages_misplaced   = %lld\n", pages_misplaced);
+	printf("numa_matrix       = %s\n", numa_matrix?"yes":"no");
 	printf("numa_max_domain   = %d\n", numa_max_domain);
 	printf("num_numa_domains  = %d\n", num_numa_domains);
+	printf("num_cpu_domains   = %d\n", num_cpu_domains);
+	printf("num_memory_domains= %d\n", num_memory_domains);
 
 	for (int i = 0; i < this->num_threads; i++) {
 		printf("%d: ", this->thread_domain[i]);
@@ -744,6 +1878,20 @@ const char* Experiment::access() {
 
 	if (this->access_pattern == RANDOM) {
 		result = "random";
+	} else if (this->access_pattern == PERMUTE) {
+		result = "permute";
+	} else if (this->access_pattern == PERMUTE_PAGES) {
+		result = "permute-pages";
+	} else if (this->access_pattern == ORDERED) {
+		result = "ordered";
+	} else if (this->access_pattern == WINDOW) {
+		result = "window";
+	} else if (this->access_pattern == ZIPF) {
+		result = "zipf";
+	} else if (this->access_pattern == HOTCOLD) {
+		result = "hotcold";
+	} else if (this->access_pattern == TRACE) {
+		result = "trace";
 	} else if (this->access_pattern == STRIDED && 0 < this->stride) {
 		result = "forward";
 	} else if (this->access_pattern == STRIDED && this->stride < 0) {
@@ -764,7 +1912,159 @@ const char* Experiment::placement() {
 		result = "add";
 	} else if (this->numa_placement == MAP) {
 		result = "map";
+	} else if (this->numa_placement == INTERLEAVE) {
+		result = "interleave";
+	} else if (this->numa_placement == CPULESS) {
+		result = "cpuless";
+	}
+
+	return result;
+}
+
+const char* Experiment::engine() {
+	const char* result = NULL;
+
+	if (this->chase_engine == SCALAR) {
+		result = "scalar";
+	} else if (this->chase_engine == GATHER) {
+		result = "gather";
+	} else if (this->chase_engine == NATIVE) {
+		result = "native";
+	} else if (this->chase_engine == STREAM) {
+		result = "stream";
+	}
+
+	return result;
+}
+
+const char* Experiment::operation() {
+	const char* result = NULL;
+
+	if (this->memory_operation == LOAD) {
+		result = "load";
+	} else if (this->memory_operation == STORE) {
+		result = "store";
+	} else if (this->memory_operation == RMW) {
+		result = "rmw";
+	}
+
+	return result;
+}
+
+const char* Experiment::link() {
+	const char* result = NULL;
+
+	if (this->link_placement == LINK_FIRST) {
+		result = "first";
+	} else if (this->link_placement == LINK_LAST) {
+		result = "last";
+	} else if (this->link_placement == LINK_RANDOM) {
+		result = "random";
+	} else if (this->link_placement == LINK_SPLIT_LINE) {
+		result = "split-line";
+	} else if (this->link_placement == LINK_SPLIT_PAGE) {
+		result = "split-page";
+	}
+
+	return result;
+}
+
+const char* Experiment::backing() {
+	const char* result = NULL;
+
+	if (this->page_backing == PAGES_DEFAULT) {
+		result = "default";
+	} else if (this->page_backing == PAGES_4K) {
+		result = "4k";
+	} else if (this->page_backing == PAGES_THP) {
+		result = "thp";
+	} else if (this->page_backing == PAGES_2M) {
+		result = "2m";
+	} else if (this->page_backing == PAGES_1G) {
+		result = "1g";
 	}
 
 	return result;
 }
+
+const char* Experiment::policy() {
+	const char* result = NULL;
+
+	if (this->numa_policy == POLICY_STRICT) {
+		result = "strict";
+	} else if (this->numa_policy == POLICY_PREFERRED) {
+		result = "preferred";
+	} else if (this->numa_policy == POLICY_INTERLEAVE) {
+		result = "interleave";
+	}
+
+	return result;
+}
+
+// tier of the memory of a domain, as seen from the cpus
+// of another: their own, that of another domain with cpus,
+// or memory without cpus of its own (CXL and the like)
+const char* Experiment::tier(int32 cpu_domain, int32 memory_domain) {
+	if (memory_domain == cpu_domain) {
+		return "local";
+	} else if (this->has_cpus(memory_domain)) {
+		return "remote";
+	}
+	return "cpu-less";
+}
+
+// tier of all chains, or mixed when they differ
+const char* Experiment::tier() {
+	const char* result = NULL;
+
+	for (int i = 0; i < this->num_threads; i++) {
+		if (this->numa_placement == INTERLEAVE) {
+			for (int j = 0; j < this->interleave_length; j++) {
+				const char* t = this->tier(this->thread_domain[i], this->interleave_nodes[j]);
+				if (result != NULL && strcmp(result, t) != 0)
+					return "mixed";
+				result = t;
+			}
+		} else {
+			for (int j = 0; j < this->chains_per_thread; j++) {
+				const char* t = this->tier(this->thread_domain[i], this->chain_domain[i][j]);
+				if (result != NULL && strcmp(result, t) != 0)
+					return "mixed";
+				result = t;
+			}
+		}
+	}
+
+	return result;
+}
+
+// offset of the link from the start of its line, for the
+// placements that put it at the same place in every line
+static int64 link_offset(Experiment &e) {
+	if (e.link_placement == Experiment::LINK_LAST) {
+		return e.bytes_per_stride - e.pointer_size;
+	} else if (e.link_placement == Experiment::LINK_SPLIT_LINE
+			|| e.link_placement == Experiment::LINK_SPLIT_PAGE) {
+		return e.bytes_per_stride - e.pointer_size / 2;
+	}
+	return 0;
+}
+
+// cache lines covered by a word at offset of a line
+static int64 lines_covered(Experiment &e, int64 offset) {
+	return (offset + e.pointer_size - 1) / e.bytes_per_line - offset / e.bytes_per_line + 1;
+}
+
+// cache lines each hop loads, two when the link straddles them
+int64 Experiment::lines_read() {
+	return lines_covered(*this, link_offset(*this));
+}
+
+// cache lines each hop dirties with its payload
+int64 Experiment::lines_written() {
+	if (this->memory_operation == LOAD) {
+		return 0;
+	}
+
+	return lines_covered(*this, link_offset(*this) + this->payload_offset);
+}
\ No newline at end of file
@@ -18,6 +18,9 @@
 #if !defined(EXPERIMENT_H)
 #define EXPERIMENT_H
 
+// System includes
+#include <cstddef>
+
 // Local includes
 #include "chain.h"
 #include "types.h"
@@ -34,14 +37,25 @@ public:
 
 	int parse_args(int argc, char* argv[]);
 	int64 parse_number(const char* s);
+	int32 parse_order(const char* s);
 	float parse_real(const char* s);
 
 	const char* placement();
 	const char* access();
+	const char* engine();
+	const char* operation();
+	const char* link();
+	const char* backing();
+	const char* policy();
+	const char* tier();
+	const char* tier(int32 cpu_domain, int32 memory_domain);
+	int64 lines_read();
+	int64 lines_written();
 
 	// fundamental parameters
     int64 pointer_size;		// number of bytes in a pointer
     int64 bytes_per_line;	// working set cache line size (bytes)
+    int64 bytes_per_stride;	// distance between the lines of the chain (bytes)
     int64 links_per_line;	// working set cache line size (links)
     int64 bytes_per_page;	// working set page size (in bytes)
     int64 lines_per_page;	// working set page size (in lines)
@@ -50,11 +64,15 @@ public:
     int64 lines_per_chain;	// working set chain size (lines)
     int64 links_per_chain;	// working set chain size (links)
     int64 pages_per_chain;	// working set chain size (pages)
+    int64 pages_per_segment;// pages linked by each chain of a thread
     int64 bytes_per_thread;	// thread working set size (bytes)
     int64 chains_per_thread;// memory loading per thread
     int64 num_threads;		// number of threads in the experiment
     int64 bytes_per_test;	// test working set size (bytes)
     int64 loop_length;		// length of the inner loop (cycles)
+    int64 unroll;			// links chased per chain between loop tests
+    int64 bytes_per_node;	// bytes read by each hop (0 for a single line)
+    bool node_simd;			// read nodes with 16-byte SIMD loads
 
     float seconds;			// number of seconds per experiment
     int64 iterations;		// number of iterations per experiment
@@ -62,28 +80,76 @@ public:
 
     enum { NONE, T0, T1, T2, NTA }
     prefetch_hint;			// use of prefetching
+    int64 prefetch_distance;// hops the prefetching cursor runs ahead
+    bool prefetch_sweep;	// measure a range of prefetch distances
+
+    enum { SCALAR, GATHER, NATIVE, STREAM }
+	chase_engine;			// code used to chase the chains
+    int64 gather_width;		// chains advanced by a single gather
+
+    enum { LOAD, STORE, RMW }
+	memory_operation;		// operation performed on each line
+    int64 payload_offset;	// offset of the payload word from the link (bytes)
+
+    enum { LINK_FIRST, LINK_LAST, LINK_RANDOM, LINK_SPLIT_LINE, LINK_SPLIT_PAGE }
+	link_placement;			// position of the link within its line
 
     enum { CSV, BOTH, HEADER, TABLE }
 	output_mode;			// results output mode
 
-    enum { RANDOM, STRIDED }
+    enum { RANDOM, STRIDED, PERMUTE, PERMUTE_PAGES, ORDERED, WINDOW, ZIPF, HOTCOLD, TRACE }
 	access_pattern;			// memory access pattern
     int64 stride;
-
-    enum { LOCAL, XOR, ADD, MAP }
+    int64 bytes_per_window;	// extent of the random order (windowed pattern)
+    float zipf_exponent;	// skew of the line popularity (zipf pattern)
+    float hot_fraction;		// fraction of the lines that are hot (hot/cold pattern)
+    float hot_share;		// fraction of the visits to hot lines (hot/cold pattern)
+    char* trace_file;		// recorded addresses to replay (trace pattern)
+    int64* trace;			// line of each recorded address
+    int64 trace_length;		// number of recorded addresses chased
+    int64 trace_skipped;	// recorded addresses whose line had no link left
+    int32* visits;			// visits of the line of each popularity rank (skewed patterns)
+    int64 capped_lines;		// lines with more visits than they have links
+    float effective_share;	// fraction of the visits to hot or capped lines
+
+    enum { ORDER_SEQUENTIAL, ORDER_REVERSE, ORDER_STRIDED, ORDER_RANDOM };
+    int32 page_order;		// order of the pages within a chain
+    int64 page_stride;
+    int32 line_order;		// order of the lines within a page
+    int64 line_stride;
+
+    enum { LOCAL, XOR, ADD, MAP, INTERLEAVE, CPULESS }
 	numa_placement;			// memory allocation mode
     int64 offset_or_mask;
     char* placement_map;
+    int32* interleave_nodes;// domain of each page in turn (interleave placement)
+    int64 interleave_length;// number of pages in one turn
+
+    enum { POLICY_STRICT, POLICY_PREFERRED, POLICY_INTERLEAVE }
+	numa_policy;			// memory policy applied to each chain
+    int64 pages_checked;	// pages whose numa domain was verified
+    int64 pages_misplaced;	// pages found outside their intended domains
+    bool numa_matrix;		// measure every pair of cpu and memory domains
 
 	// maps threads and chains to numa domains
     int32* thread_domain;	// thread_domain[thread]
     int32** chain_domain;	// chain_domain[thread][chain]
     int32 numa_max_domain;	// highest numa domain id
     int32 num_numa_domains;	// number of numa domains
-
-    char** random_state;	// random state for each thread
+    int32* cpu_domains;		// domains with cpus, which run the threads
+    int32 num_cpu_domains;
+    int32* memory_domains;	// domains with memory, which hold the chains
+    int32 num_memory_domains;
 
     bool strict;			// strictly adhere to user input, or fail
+    bool cold;				// flush the chains from the caches before each iteration
+    bool check;				// verify every chain is a single cycle before measuring
+    bool shared_chain;		// all threads chase segments of a single chain
+
+    enum { PAGES_DEFAULT, PAGES_4K, PAGES_THP, PAGES_2M, PAGES_1G }
+	page_backing;			// pages backing the chains
+    int64 backing_page_size;// size of the pages obtained (bytes)
+    float huge_page_share;	// fraction of the chains in huge pages
 
     const static int32 DEFAULT_POINTER_SIZE      = sizeof(Chain);
     const static int32 DEFAULT_BYTES_PER_LINE    = 64;
@@ -100,6 +166,14 @@ public:
     const static int32 DEFAULT_THREADS           = 1;
     const static int32 DEFAULT_BYTES_PER_TEST    = DEFAULT_BYTES_PER_THREAD * DEFAULT_THREADS;
     const static int32 DEFAULT_LOOPLENGTH        = 0;
+    const static int32 DEFAULT_UNROLL            = 1;
+    const static int32 MAX_GATHER_GROUPS         = 7;
+    const static int32 DEFAULT_PREFETCH_DISTANCE = 0;
+    const static int32 MAX_PREFETCH_DISTANCE     = 64;
+    const static int32 MAX_PREFETCH_CHAINS       = 6;
+    const static int32 MIN_BYTES_PER_NODE        = 16;
+    const static int32 MAX_BYTES_PER_NODE        = 4096;
+    const static int32 MAX_INTERLEAVE_WEIGHT     = 1024;
     const static int32 DEFAULT_SECONDS           = 1;
     const static int32 DEFAULT_ITERATIONS        = 0;
     const static int32 DEFAULT_EXPERIMENTS       = 1;
@@ -108,6 +182,14 @@ public:
 	void alloc_xor();
 	void alloc_add();
 	void alloc_map();
+	void alloc_interleave();
+	void alloc_cpuless();
+	void discover_domains();
+	bool has_cpus(int32 domain);
+	void alloc_pair(int32 cpu_domain, int32 memory_domain, int64 threads, int64 chains);
+	int64 domain_cpus(int32 domain);
+	int load_trace();
+	int count_visits();
 
 	void print();
 
@@ -115,6 +197,21 @@ private:
 };
 
 
+inline const char* order_string(int32 order) {
+	switch (order) {
+	case Experiment::ORDER_SEQUENTIAL:
+		return "sequential";
+	case Experiment::ORDER_REVERSE:
+		return "reverse";
+	case Experiment::ORDER_STRIDED:
+		return "strided";
+	case Experiment::ORDER_RANDOM:
+		return "random";
+	}
+
+	return NULL;
+}
+
 inline const char* prefetch_hint_string(int32 prefetch_hint) {
 	switch (prefetch_hint) {
 	case Experiment::NONE:
@@ -128,6 +225,8 @@ inline const char* prefetch_hint_string(int32 prefetch_hint) {
 	case Experiment::NTA:
 		return "nta";
 	}
+
+	return NULL;
 }
 
 #endif
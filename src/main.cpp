@@ -62,6 +62,71 @@
 
 int verbose = 0;
 
+// run the threads of the experiment to completion
+static void chase(Experiment &e) {
+	Thread::reset();
+	SpinBarrier sb(e.num_threads);
+	Run r[e.num_threads];
+	for (int i = 0; i < e.num_threads; i++) {
+		r[i].set(e, &sb);
+		r[i].start();
+	}
+
+	for (int i = 0; i < e.num_threads; i++) {
+		r[i].wait();
+	}
+}
+
+static double average(const std::vector<double> &seconds) {
+	double sum = 0;
+	for (size_t i = 0; i < seconds.size(); i++)
+		sum += seconds[i];
+	return sum / seconds.size();
+}
+
+// measure latency and bandwidth between every pair of
+// domains, with a fresh set of threads for every run
+static std::vector<Pair> matrix(Experiment &e) {
+	int64 threads = e.num_threads;
+	int64 chains = e.chains_per_thread;
+	int64 iterations = e.iterations;
+	std::vector<Pair> pairs;
+
+	// threads only run on domains with cpus, but
+	// memory-only domains are measured as well
+	for (int c = 0; c < e.num_cpu_domains; c++) {
+		for (int m = 0; m < e.num_memory_domains; m++) {
+			int32 cpu = e.cpu_domains[c];
+			int32 memory = e.memory_domains[m];
+			Pair pair;
+			pair.cpu_domain = cpu;
+			pair.memory_domain = memory;
+			pair.tier = e.tier(cpu, memory);
+
+			// latency of a single chain
+			e.alloc_pair(cpu, memory, 1, 1);
+			e.iterations = iterations;
+			Run::reset();
+			chase(e);
+			pair.latency = average(Run::seconds())
+					/ (Run::ops_per_chain() * e.iterations) * 1E9;
+
+			// bandwidth of all threads of the domain
+			pair.threads = (1 < threads) ? threads : e.domain_cpus(cpu);
+			e.alloc_pair(cpu, memory, pair.threads, chains);
+			e.iterations = iterations;
+			Run::reset();
+			chase(e);
+			pair.bandwidth = Run::ops_per_chain() * e.iterations * chains * pair.threads
+					* e.bytes_per_line / average(Run::seconds()) * 1E-6;
+
+			pairs.push_back(pair);
+		}
+	}
+
+	return pairs;
+}
+
 int main(int argc, char* argv[]) {
 	Timer::calibrate(10000);
 	double clk_res = Timer::resolution();
@@ -71,18 +136,24 @@ int main(int argc, char* argv[]) {
 		return 0;
 	}
 
-	SpinBarrier sb(e.num_threads);
-	Run r[e.num_threads];
-	for (int i = 0; i < e.num_threads; i++) {
-		r[i].set(e, &sb);
-		r[i].start();
+	if (e.numa_matrix) {
+		Output::print(e, matrix(e));
+		return 0;
 	}
 
-	for (int i = 0; i < e.num_threads; i++) {
-		r[i].wait();
+	chase(e);
+
+	if (e.chase_engine == Experiment::STREAM) {
+		Output::print(e, Run::streams());
+		return 0;
 	}
 
 	int64 ops = Run::ops_per_chain();
+	if (e.prefetch_sweep) {
+		Output::print(e, ops, Run::sweeps(), clk_res);
+		return 0;
+	}
+
 	std::vector<double> seconds = Run::seconds();
 
 	Output::print(e, ops, seconds, clk_res);
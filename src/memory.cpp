@@ -0,0 +1,346 @@
+/*******************************************************************************
+ * Copyright (c) 2006 International Business Machines Corporation.             *
+ * All rights reserved. This program and the accompanying materials            *
+ * are made available under the terms of the Common Public License v1.0        *
+ * which accompanies this distribution, and is available at                    *
+ * http://www.opensource.org/licenses/cpl1.0.php                               *
+ *                                                                             *
+ * Contributors:                                                               *
+ *    Douglas M. Pase - initial API and implementation                         *
+ *    Tim Besard - prefetching, JIT compilation                                *
+ *******************************************************************************/
+
+//
+// Configuration
+//
+
+// Implementation header
+#include "memory.h"
+
+// System includes
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <sys/mman.h>
+#if defined(NUMA)
+#include <numaif.h>
+#endif
+
+// Local includes
+#include "experiment.h"
+
+// older headers lack the encoding of the hugetlb page size
+#if !defined(MAP_HUGE_SHIFT)
+#define MAP_HUGE_SHIFT 26
+#endif
+
+
+//
+// Implementation
+//
+
+static const int64 BASE_PAGE_SIZE = 4096;
+static const int64 HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+static const int64 GIGANTIC_PAGE_SIZE = 1024 * 1024 * 1024;
+
+// pages passed to a single move_pages call
+static const int64 MOVE_PAGES_BATCH = 4096;
+
+// size of the pages of transparent huge pages
+static int64 thp_size() {
+	int64 size = HUGE_PAGE_SIZE;
+	FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+	if (f != NULL) {
+		long long n = 0;
+		if (fscanf(f, "%lld", &n) == 1 && 0 < n) {
+			size = n;
+		}
+		fclose(f);
+	}
+	return size;
+}
+
+// granularity at which the kernel faults the pages in,
+// which may be smaller than the pages requested
+static int64 fault_size(int32 pages) {
+	if (pages == Experiment::PAGES_2M || pages == Experiment::PAGES_1G) {
+		return Memory::page_size(pages);
+	}
+	return BASE_PAGE_SIZE;
+}
+
+// size of the pages requested, which
+// is also the alignment of the mapping
+int64 Memory::page_size(int32 pages) {
+	switch (pages) {
+	case Experiment::PAGES_THP:
+		return thp_size();
+	case Experiment::PAGES_2M:
+		return HUGE_PAGE_SIZE;
+	case Experiment::PAGES_1G:
+		return GIGANTIC_PAGE_SIZE;
+	default:
+		return BASE_PAGE_SIZE;
+	}
+}
+
+// bytes mapped for a chain of the given size
+int64 Memory::mapped(int64 bytes, int32 pages) {
+	int64 size = Memory::page_size(pages);
+	return (bytes + size - 1) / size * size;
+}
+
+// pages left in the hugetlb pool, or -1
+// when the pages do not come from a pool
+int64 Memory::free_pages(int32 pages) {
+	if (pages != Experiment::PAGES_2M && pages != Experiment::PAGES_1G) {
+		return -1;
+	}
+
+	char path[128];
+	snprintf(path, sizeof path, "/sys/kernel/mm/hugepages/hugepages-%lldkB/free_hugepages",
+			Memory::page_size(pages) / 1024);
+	int64 count = 0;
+	FILE* f = fopen(path, "r");
+	if (f != NULL) {
+		long long n = 0;
+		if (fscanf(f, "%lld", &n) == 1) {
+			count = n;
+		}
+		fclose(f);
+	}
+	return count;
+}
+
+Chain* Memory::allocate(int64 bytes, int32 pages) {
+	int64 size = Memory::mapped(bytes, pages);
+	// chains with lines larger than a page only touch part
+	// of their memory, so only hugetlb pages are reserved
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+	if (pages == Experiment::PAGES_2M || pages == Experiment::PAGES_1G) {
+		flags &= ~MAP_NORESERVE;
+	}
+	if (pages == Experiment::PAGES_2M) {
+		flags |= MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);
+	} else if (pages == Experiment::PAGES_1G) {
+		flags |= MAP_HUGETLB | (30 << MAP_HUGE_SHIFT);
+	}
+
+	// transparent huge pages are only used for aligned
+	// ranges, so map one page more and trim both ends
+	int64 align = (pages == Experiment::PAGES_THP) ? Memory::page_size(pages) : 0;
+	char* memory = (char*) mmap(NULL, size + align, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (memory == MAP_FAILED) {
+		return NULL;
+	}
+	if (0 < align) {
+		int64 head = (align - (uint64) memory % align) % align;
+		if (0 < head) {
+			munmap(memory, head);
+		}
+		munmap(memory + head + size, align - head);
+		memory += head;
+	}
+
+	if (pages == Experiment::PAGES_THP) {
+		madvise(memory, size, MADV_HUGEPAGE);
+	} else if (pages == Experiment::PAGES_4K) {
+		madvise(memory, size, MADV_NOHUGEPAGE);
+	}
+
+	return (Chain*) memory;
+}
+
+void Memory::release(Chain* memory, int64 bytes, int32 pages) {
+	if (memory != NULL) {
+		munmap(memory, Memory::mapped(bytes, pages));
+	}
+}
+
+// size of the pages backing most of the mapping that
+// holds memory, as reported by the kernel. the share
+// is the fraction of its resident memory in huge pages.
+int64 Memory::backing(const void* memory, float &huge_share) {
+	int64 page = 0;
+	huge_share = 0;
+
+	FILE* f = fopen("/proc/self/smaps", "r");
+	if (f == NULL) {
+		return page;
+	}
+
+	// every mapping starts with its address range,
+	// followed by one "Field: value kB" line per field
+	uint64 address = (uint64) memory;
+	bool inside = false;
+	int64 rss = 0, anon_huge = 0, kernel_page = 0;
+	char line[512];
+	while (fgets(line, sizeof line, f) != NULL) {
+		unsigned long long start, end;
+		long long n;
+		if (sscanf(line, "%llx-%llx ", &start, &end) == 2) {
+			if (inside) {
+				break;
+			}
+			inside = (start <= address && address < end);
+		} else if (!inside) {
+			continue;
+		} else if (sscanf(line, "Rss: %lld kB", &n) == 1) {
+			rss = n * 1024;
+		} else if (sscanf(line, "AnonHugePages: %lld kB", &n) == 1) {
+			anon_huge = n * 1024;
+		} else if (sscanf(line, "KernelPageSize: %lld kB", &n) == 1) {
+			kernel_page = n * 1024;
+		}
+	}
+	fclose(f);
+
+	page = kernel_page;
+	if (BASE_PAGE_SIZE < kernel_page) {
+		huge_share = 1;
+	} else if (0 < rss) {
+		huge_share = (float) anon_huge / rss;
+		if (0.5 <= huge_share) {
+			page = thp_size();
+		}
+	}
+
+	return page;
+}
+
+// apply the numa policy to the pages of memory. the range
+// may start within a page, which is then included, as the
+// segments of a shared chain need not be page aligned.
+int Memory::bind(Chain* memory, int64 bytes, int32 pages, int32 policy,
+		const std::vector<int32> &nodes) {
+#if defined(NUMA)
+	int64 size = fault_size(pages);
+	char* start = (char*) ((uint64) memory / size * size);
+	int64 length = (char*) memory + bytes - start;
+
+	const int64 bits = 8 * sizeof(unsigned long);
+	int32 max_node = 0;
+	for (size_t i = 0; i < nodes.size(); i++) {
+		max_node = std::max(max_node, nodes[i]);
+	}
+	std::vector<unsigned long> mask(max_node / bits + 1, 0);
+	for (size_t i = 0; i < nodes.size(); i++) {
+		mask[nodes[i] / bits] |= 1UL << (nodes[i] % bits);
+	}
+
+	int mode = MPOL_BIND;
+	if (policy == Experiment::POLICY_PREFERRED) {
+		mode = MPOL_PREFERRED;
+	} else if (policy == Experiment::POLICY_INTERLEAVE) {
+		mode = MPOL_INTERLEAVE;
+	}
+
+	return mbind(start, length, mode, &mask[0], max_node + 2, 0);
+#else
+	return 0;
+#endif
+}
+
+// fault the pages of memory in from the calling thread, so
+// the page faults are taken in parallel by all threads rather
+// than by the chain builders. lines larger than a page only
+// have their first and last page faulted in, as links and
+// payloads sit at either end of their line.
+void Memory::prefault(Chain* memory, int64 bytes, int32 pages, int64 line) {
+	int64 size = fault_size(pages);
+	volatile char* start = (volatile char*) memory;
+	if (size < line) {
+		for (int64 offset = 0; offset < bytes; offset += line) {
+			start[offset] = start[offset];
+			int64 end = std::min(offset + line, bytes) - 1;
+			start[end] = start[end];
+		}
+	} else {
+		for (int64 offset = 0; offset < bytes; offset += size) {
+			start[offset] = start[offset];
+		}
+	}
+	start[bytes - 1] = start[bytes - 1];
+}
+
+// pages of memory that reside outside of nodes, out of the
+// pages checked, as reported by the kernel. pages that are
+// not present are not checked.
+int64 Memory::misplaced(const Chain* memory, int64 bytes, int32 pages,
+		const std::vector<int32> &nodes, int64 &checked) {
+	int64 count = 0;
+	checked = 0;
+#if defined(NUMA)
+	int64 size = fault_size(pages);
+	char* start = (char*) ((uint64) memory / size * size);
+	int64 n = ((char*) memory + bytes - start + size - 1) / size;
+
+	// ask the kernel a batch of pages at a time
+	std::vector<void*> addresses(std::min(n, MOVE_PAGES_BATCH));
+	std::vector<int> status(addresses.size());
+	for (int64 first = 0; first < n; first += MOVE_PAGES_BATCH) {
+		int64 batch = std::min(n - first, MOVE_PAGES_BATCH);
+		for (int64 i = 0; i < batch; i++) {
+			addresses[i] = start + (first + i) * size;
+			status[i] = -1;
+		}
+		if (move_pages(0, batch, &addresses[0], NULL, &status[0], 0) != 0) {
+			fprintf(stderr, "chase: unable to query the domains of %lld pages: %s\n",
+					n - first, strerror(errno));
+			break;
+		}
+
+		for (int64 i = 0; i < batch; i++) {
+			if (status[i] < 0) {
+				continue;
+			}
+			checked++;
+			if (std::find(nodes.begin(), nodes.end(), status[i]) == nodes.end()) {
+				count++;
+			}
+		}
+	}
+#endif
+	return count;
+}
+
+// move the pages of memory to the domains of the sequence in
+// turn, and return how many of the pages checked could not be
+// moved to their domain. the pages must have been faulted in.
+int64 Memory::distribute(Chain* memory, int64 bytes, int32 pages,
+		const std::vector<int32> &sequence, int64 &checked) {
+	int64 count = 0;
+	checked = 0;
+#if defined(NUMA)
+	int64 size = fault_size(pages);
+	char* start = (char*) ((uint64) memory / size * size);
+	int64 n = ((char*) memory + bytes - start + size - 1) / size;
+
+	// move a batch of pages at a time
+	std::vector<void*> addresses(std::min(n, MOVE_PAGES_BATCH));
+	std::vector<int> nodes(addresses.size());
+	std::vector<int> status(addresses.size());
+	for (int64 first = 0; first < n; first += MOVE_PAGES_BATCH) {
+		int64 batch = std::min(n - first, MOVE_PAGES_BATCH);
+		for (int64 i = 0; i < batch; i++) {
+			addresses[i] = start + (first + i) * size;
+			nodes[i] = sequence[(first + i) % sequence.size()];
+			status[i] = -1;
+		}
+		if (move_pages(0, batch, &addresses[0], &nodes[0], &status[0], MPOL_MF_MOVE) < 0) {
+			fprintf(stderr, "chase: unable to move %lld pages to their domains: %s\n",
+					n - first, strerror(errno));
+			break;
+		}
+
+		for (int64 i = 0; i < batch; i++) {
+			checked++;
+			if (status[i] != nodes[i]) {
+				count++;
+			}
+		}
+	}
+#endif
+	return count;
+}
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * Copyright (c) 2006 International Business Machines Corporation.             *
+ * All rights reserved. This program and the accompanying materials            *
+ * are made available under the terms of the Common Public License v1.0        *
+ * which accompanies this distribution, and is available at                    *
+ * http://www.opensource.org/licenses/cpl1.0.php                               *
+ *                                                                             *
+ * Contributors:                                                               *
+ *    Douglas M. Pase - initial API and implementation                         *
+ *    Tim Besard - prefetching, JIT compilation                                *
+ *******************************************************************************/
+
+//
+// Configuration
+//
+
+// Include guard
+#if !defined(MEMORY_H)
+#define MEMORY_H
+
+// System includes
+#include <vector>
+
+// Local includes
+#include "chain.h"
+#include "types.h"
+
+
+//
+// Class definition
+//
+
+// Memory backing the chains. Chains are mapped rather than
+// allocated with new[], so the size of their pages can be
+// chosen, and verified afterwards.
+class Memory {
+public:
+	static Chain* allocate(int64 bytes, int32 pages);
+	static void release(Chain* memory, int64 bytes, int32 pages);
+	static int64 mapped(int64 bytes, int32 pages);
+	static int64 page_size(int32 pages);
+	static int64 free_pages(int32 pages);
+	static int64 backing(const void* memory, float &huge_share);
+	static int bind(Chain* memory, int64 bytes, int32 pages, int32 policy,
+			const std::vector<int32> &nodes);
+	static void prefault(Chain* memory, int64 bytes, int32 pages, int64 line);
+	static int64 misplaced(const Chain* memory, int64 bytes, int32 pages,
+			const std::vector<int32> &nodes, int64 &checked);
+	static int64 distribute(Chain* memory, int64 bytes, int32 pages,
+			const std::vector<int32> &sequence, int64 &checked);
+private:
+};
+
+#endif
@@ -0,0 +1,235 @@
+/*******************************************************************************
+ * Copyright (c) 2006 International Business Machines Corporation.             *
+ * All rights reserved. This program and the accompanying materials            *
+ * are made available under the terms of the Common Public License v1.0        *
+ * which accompanies this distribution, and is available at                    *
+ * http://www.opensource.org/licenses/cpl1.0.php                               *
+ *                                                                             *
+ * Contributors:                                                               *
+ *    Douglas M. Pase - initial API and implementation                         *
+ *    Tim Besard - prefetching, JIT compilation                                *
+ *******************************************************************************/
+
+//
+// Configuration
+//
+
+// Implementation header
+#include "native.h"
+
+// System includes
+#include <cstddef>
+
+
+//
+// Implementation
+//
+
+int64 Native::ops_per_chain = 0;
+int64 Native::loop_length = 0;
+
+// Current position of each chain. The recursion is resolved
+// at compile time into one scalar per chain, which leaves the
+// cursors in registers just like the JIT kernel does.
+template <int N, int HINT, int OP>
+struct Cursors {
+	Cursors<N - 1, HINT, OP> rest;
+	const Chain* position;
+
+	inline void load(const Chain** root) {
+		rest.load(root);
+		position = root[N - 1];
+	}
+
+	inline void store(const Chain** root) {
+		rest.store(root);
+		root[N - 1] = position;
+	}
+
+	// Process all links
+	inline void chase() {
+		rest.chase();
+
+		// Chase pointer
+		position = position->next;
+
+		// Prefetch next
+		switch (HINT)
+		{
+		case Experiment::T0:
+			__builtin_prefetch(position, 0, 3);
+			break;
+		case Experiment::T1:
+			__builtin_prefetch(position, 0, 2);
+			break;
+		case Experiment::T2:
+			__builtin_prefetch(position, 0, 1);
+			break;
+		case Experiment::NTA:
+			__builtin_prefetch(position, 0, 0);
+			break;
+		case Experiment::NONE:
+		default:
+			break;
+		}
+
+		// Dirty the line through the word following the link
+		volatile ptrdiff_t* payload = (volatile ptrdiff_t*) (position + 1);
+		switch (OP)
+		{
+		case Experiment::STORE:
+			*payload = (ptrdiff_t) position;
+			break;
+		case Experiment::RMW:
+			*payload += 1;
+			break;
+		case Experiment::LOAD:
+		default:
+			break;
+		}
+	}
+};
+
+template <int HINT, int OP>
+struct Cursors<0, HINT, OP> {
+	inline void load(const Chain** root) {
+	}
+	inline void store(const Chain** root) {
+	}
+	inline void chase() {
+	}
+};
+
+// Wait
+static inline void wait(int64 loop_length) {
+	for (int64 i = 0; i < loop_length; i++)
+		__asm__ __volatile__("nop");
+}
+
+// Process an unrolled block of links
+template <int UNROLL, int CHAINS, int HINT, int OP>
+struct Block {
+	static inline void chase(Cursors<CHAINS, HINT, OP> &cursors, int64 loop_length) {
+		Block<UNROLL - 1, CHAINS, HINT, OP>::chase(cursors, loop_length);
+		cursors.chase();
+		wait(loop_length);
+	}
+};
+
+template <int CHAINS, int HINT, int OP>
+struct Block<0, CHAINS, HINT, OP> {
+	static inline void chase(Cursors<CHAINS, HINT, OP> &cursors, int64 loop_length) {
+	}
+};
+
+template <int CHAINS, int UNROLL, int HINT, int OP>
+void Native::chase(const Chain** root) {
+	// Current position, starting at the root of each chain
+	Cursors<CHAINS, HINT, OP> cursors;
+	cursors.load(root);
+
+	// Whole unrolled blocks, followed by the links
+	// that do not fill a block, so every chain makes
+	// exactly one cycle back to its root
+	const int64 blocks = Native::ops_per_chain / UNROLL;
+	const int64 remainder = Native::ops_per_chain % UNROLL;
+	const int64 loop_length = Native::loop_length;
+	for (int64 b = 0; b < blocks; b++)
+		Block<UNROLL, CHAINS, HINT, OP>::chase(cursors, loop_length);
+	for (int64 u = 0; u < remainder; u++)
+		Block<1, CHAINS, HINT, OP>::chase(cursors, loop_length);
+
+	// Store the cursors, which are back at their roots, so the
+	// compiler cannot discard the loads that produced them
+	cursors.store(root);
+}
+
+template <int CHAINS, int UNROLL, int HINT>
+Native::kernel Native::select_operation(int32 memory_operation) {
+	switch (memory_operation) {
+	case Experiment::STORE:
+		return Native::chase<CHAINS, UNROLL, HINT, Experiment::STORE>;
+	case Experiment::RMW:
+		return Native::chase<CHAINS, UNROLL, HINT, Experiment::RMW>;
+	case Experiment::LOAD:
+	default:
+		return Native::chase<CHAINS, UNROLL, HINT, Experiment::LOAD>;
+	}
+}
+
+template <int CHAINS, int UNROLL>
+Native::kernel Native::select_hint(int32 prefetch_hint, int32 memory_operation) {
+	switch (prefetch_hint) {
+	case Experiment::T0:
+		return Native::select_operation<CHAINS, UNROLL, Experiment::T0>(memory_operation);
+	case Experiment::T1:
+		return Native::select_operation<CHAINS, UNROLL, Experiment::T1>(memory_operation);
+	case Experiment::T2:
+		return Native::select_operation<CHAINS, UNROLL, Experiment::T2>(memory_operation);
+	case Experiment::NTA:
+		return Native::select_operation<CHAINS, UNROLL, Experiment::NTA>(memory_operation);
+	case Experiment::NONE:
+	default:
+		return Native::select_operation<CHAINS, UNROLL, Experiment::NONE>(memory_operation);
+	}
+}
+
+template <int CHAINS>
+Native::kernel Native::select_unroll(int64 unroll, int32 prefetch_hint, int32 memory_operation) {
+	switch (unroll) {
+	case 1:
+		return Native::select_hint<CHAINS, 1>(prefetch_hint, memory_operation);
+	case 2:
+		return Native::select_hint<CHAINS, 2>(prefetch_hint, memory_operation);
+	case 4:
+		return Native::select_hint<CHAINS, 4>(prefetch_hint, memory_operation);
+	case 8:
+		return Native::select_hint<CHAINS, 8>(prefetch_hint, memory_operation);
+	case 16:
+		return Native::select_hint<CHAINS, 16>(prefetch_hint, memory_operation);
+	default:
+		return 0;
+	}
+}
+
+Native::kernel Native::select(Experiment &e, int64 ops_per_chain) {
+	Native::ops_per_chain = ops_per_chain;
+	Native::loop_length = e.loop_length;
+
+	switch (e.chains_per_thread) {
+	case 1:
+		return Native::select_unroll<1>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 2:
+		return Native::select_unroll<2>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 3:
+		return Native::select_unroll<3>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 4:
+		return Native::select_unroll<4>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 5:
+		return Native::select_unroll<5>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 6:
+		return Native::select_unroll<6>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 7:
+		return Native::select_unroll<7>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 8:
+		return Native::select_unroll<8>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 9:
+		return Native::select_unroll<9>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 10:
+		return Native::select_unroll<10>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 11:
+		return Native::select_unroll<11>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 12:
+		return Native::select_unroll<12>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 13:
+		return Native::select_unroll<13>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 14:
+		return Native::select_unroll<14>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 15:
+		return Native::select_unroll<15>(e.unroll, e.prefetch_hint, e.memory_operation);
+	case 16:
+		return Native::select_unroll<16>(e.unroll, e.prefetch_hint, e.memory_operation);
+	default:
+		return 0;
+	}
+}
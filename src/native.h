@@ -0,0 +1,63 @@
+/*******************************************************************************
+ * Copyright (c) 2006 International Business Machines Corporation.             *
+ * All rights reserved. This program and the accompanying materials            *
+ * are made available under the terms of the Common Public License v1.0        *
+ * which accompanies this distribution, and is available at                    *
+ * http://www.opensource.org/licenses/cpl1.0.php                               *
+ *                                                                             *
+ * Contributors:                                                               *
+ *    Douglas M. Pase - initial API and implementation                         *
+ *    Tim Besard - prefetching, JIT compilation                                *
+ *******************************************************************************/
+
+//
+// Configuration
+//
+
+// Include guard
+#if !defined(NATIVE_H)
+#define NATIVE_H
+
+// Local includes
+#include "chain.h"
+#include "types.h"
+#include "experiment.h"
+
+
+//
+// Class definition
+//
+
+/*
+ * The native engine is the compiled counterpart of the JIT kernels: a
+ * table of template instantiations specialized on the amount of chains,
+ * the unroll factor, the prefetch hint and the memory operation. It needs no executable data
+ * memory, so it also runs where W^X policies rule out JIT compilation.
+ */
+
+class Native {
+public:
+	typedef void (*kernel)(const Chain**);
+
+	static kernel select(Experiment &e, int64 ops_per_chain);
+
+	const static int32 MAX_CHAINS = 16;
+	const static int32 MAX_UNROLL = 16;
+
+private:
+	template <int CHAINS, int UNROLL, int HINT, int OP>
+	static void chase(const Chain** root);
+
+	template <int CHAINS, int UNROLL, int HINT>
+	static kernel select_operation(int32 memory_operation);
+	template <int CHAINS, int UNROLL>
+	static kernel select_hint(int32 prefetch_hint, int32 memory_operation);
+	template <int CHAINS>
+	static kernel select_unroll(int64 unroll, int32 prefetch_hint, int32 memory_operation);
+
+	// run-time parameters, shared by all threads
+	static int64 ops_per_chain;
+	static int64 loop_length;
+};
+
+#endif
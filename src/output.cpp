@@ -56,12 +56,37 @@ void Output::header(Experiment &e, int64 ops, double ck_res) {
     printf("number of threads,");
     printf("iterations,");
     printf("loop length,");
+    printf("unroll,");
+    printf("node size (bytes),");
+    printf("node loads,");
     printf("prefetch hint,");
+    printf("prefetch distance,");
+    printf("chase engine,");
+    printf("memory operation,");
+    printf("link placement,");
     printf("experiments,");
+    printf("cold,");
+    printf("shared chain,");
+    printf("page backing,");
+    printf("backing page size (bytes),");
+    printf("huge page share,");
     printf("access pattern,");
     printf("stride,");
+    printf("window size (bytes),");
+    printf("zipf exponent,");
+    printf("hot fraction,");
+    printf("hot share,");
+    printf("capped lines,");
+    printf("effective hot share,");
+    printf("skipped trace visits,");
+    printf("page order,");
+    printf("line order,");
     printf("numa placement,");
     printf("offset or mask,");
+    printf("interleave nodes,");
+    printf("memory policy,");
+    printf("misplaced pages,");
+    printf("memory tier,");
     printf("numa domains,");
     printf("domain map,");
     printf("operations per chain,");
@@ -70,29 +95,62 @@ void Output::header(Experiment &e, int64 ops, double ck_res) {
     printf("elapsed time (timer ticks),");
     printf("clock resolution (ns),", ck_res * 1E9);
     printf("memory latency (ns),");
-    printf("memory bandwidth (MB/s)\n");
+    printf("hop rate (Mhops/s),");
+    printf("memory bandwidth (MB/s),");
+    printf("memory bandwidth incl. write-back (MB/s)\n");
 
     fflush(stdout);
 }
 
 void Output::csv(Experiment &e, int64 ops, double secs, double ck_res) {
-    printf("%ld,", e.pointer_size);
-    printf("%ld,", e.bytes_per_line);
-    printf("%ld,", e.bytes_per_page);
-    printf("%ld,", e.bytes_per_chain);
-    printf("%ld,", e.bytes_per_thread);
-    printf("%ld,", e.bytes_per_test);
+    printf("%lld,", e.pointer_size);
+    printf("%lld,", e.bytes_per_line);
+    printf("%lld,", e.bytes_per_page);
+    printf("%lld,", e.bytes_per_chain);
+    printf("%lld,", e.bytes_per_thread);
+    printf("%lld,", e.bytes_per_test);
     printf("%lld,", e.chains_per_thread);
-    printf("%ld,", e.num_threads);
-    printf("%ld,", e.iterations);
-    printf("%ld,", e.loop_length);
+    printf("%lld,", e.num_threads);
+    printf("%lld,", e.iterations);
+    printf("%lld,", e.loop_length);
+    printf("%lld,", e.unroll);
+    printf("%lld,", e.bytes_per_node);
+    printf("%s,", e.node_simd ? "simd" : "scalar");
     printf("%s,", prefetch_hint_string(e.prefetch_hint));
-    printf("%ld,", e.experiments);
+    printf("%lld,", e.prefetch_distance);
+    printf("%s,", e.engine());
+    printf("%s,", e.operation());
+    printf("%s,", e.link());
+    printf("%lld,", e.experiments);
+    printf("%s,", e.cold ? "yes" : "no");
+    printf("%s,", e.shared_chain ? "yes" : "no");
+    printf("%s,", e.backing());
+    printf("%lld,", e.backing_page_size);
+    printf("%.3f,", e.huge_page_share);
     printf("%s,", e.access());
-    printf("%ld,", e.stride);
+    printf("%lld,", e.stride);
+    printf("%lld,", e.bytes_per_window);
+    printf("%.2f,", e.zipf_exponent);
+    printf("%.3f,", e.hot_fraction);
+    printf("%.3f,", e.hot_share);
+    printf("%lld,", e.capped_lines);
+    printf("%.3f,", e.effective_share);
+    printf("%lld,", e.trace_skipped);
+    printf("%s", order_string(e.page_order));
+    if (e.page_order == Experiment::ORDER_STRIDED)
+        printf(" %lld", e.page_stride);
+    printf(",");
+    printf("%s", order_string(e.line_order));
+    if (e.line_order == Experiment::ORDER_STRIDED)
+        printf(" %lld", e.line_stride);
+    printf(",");
     printf("%s,", e.placement());
-    printf("%ld,", e.offset_or_mask);
-    printf("%ld,", e.num_numa_domains);
+    printf("%lld,", e.offset_or_mask);
+    printf("\"%s\",", e.numa_placement == Experiment::INTERLEAVE ? e.placement_map : "");
+    printf("%s,", e.policy());
+    printf("%lld,", e.pages_misplaced);
+    printf("%s,", e.tier());
+    printf("%d,", e.num_numa_domains);
     printf("\"");
     printf("%d:", e.thread_domain[0]);
     printf("%d", e.chain_domain[0][0]);
@@ -107,35 +165,69 @@ void Output::csv(Experiment &e, int64 ops, double secs, double ck_res) {
 		}
 	}
     printf("\",");
-    printf("%ld,", ops);
-    printf("%ld,", ops * e.chains_per_thread * e.num_threads);
+    printf("%lld,", ops);
+    printf("%lld,", ops * e.chains_per_thread * e.num_threads);
     printf("%.3f,", secs);
     printf("%.0f,", secs/ck_res);
     printf("%.2f,", ck_res * 1E9);
     printf("%.2f,", (secs / (ops * e.iterations)) * 1E9);
-    printf("%.3f\n", ((ops * e.iterations * e.chains_per_thread * e.num_threads * e.bytes_per_line) / secs) * 1E-6);
+    printf("%.3f,", ((ops * e.iterations * e.chains_per_thread * e.num_threads) / secs) * 1E-6);
+    printf("%.3f,", ((ops * e.iterations * e.chains_per_thread * e.num_threads * e.bytes_per_line * e.lines_read()) / secs) * 1E-6);
+    printf("%.3f\n", ((ops * e.iterations * e.chains_per_thread * e.num_threads * e.bytes_per_line * (e.lines_read() + e.lines_written())) / secs) * 1E-6);
 
     fflush(stdout);
 }
 
 void Output::table(Experiment &e, int64 ops, double secs, double ck_res) {
-    printf("pointer size         = %ld (bytes)\n", e.pointer_size);
-    printf("cache line size      = %ld (bytes)\n", e.bytes_per_line);
-    printf("page size            = %ld (bytes)\n", e.bytes_per_page);
-    printf("chain size           = %ld (bytes)\n", e.bytes_per_chain);
-    printf("thread size          = %ld (bytes)\n", e.bytes_per_thread);
-    printf("test size            = %ld (bytes)\n", e.bytes_per_test);
-    printf("chains per thread    = %ld\n", e.chains_per_thread);
-    printf("number of threads    = %ld\n", e.num_threads);
-    printf("iterations           = %ld\n", e.iterations);
-    printf("loop length          = %ld\n", e.loop_length);
+    printf("pointer size         = %lld (bytes)\n", e.pointer_size);
+    printf("cache line size      = %lld (bytes)\n", e.bytes_per_line);
+    printf("page size            = %lld (bytes)\n", e.bytes_per_page);
+    printf("chain size           = %lld (bytes)\n", e.bytes_per_chain);
+    printf("thread size          = %lld (bytes)\n", e.bytes_per_thread);
+    printf("test size            = %lld (bytes)\n", e.bytes_per_test);
+    printf("chains per thread    = %lld\n", e.chains_per_thread);
+    printf("number of threads    = %lld\n", e.num_threads);
+    printf("iterations           = %lld\n", e.iterations);
+    printf("loop length          = %lld\n", e.loop_length);
+    printf("unroll               = %lld\n", e.unroll);
+    printf("node size            = %lld (bytes)\n", e.bytes_per_node);
+    printf("node loads           = %s\n", e.node_simd ? "simd" : "scalar");
     printf("prefetch hint        = %s\n", prefetch_hint_string(e.prefetch_hint));
-    printf("experiments          = %ld\n", e.experiments);
+    printf("prefetch distance    = %lld\n", e.prefetch_distance);
+    printf("chase engine         = %s\n", e.engine());
+    printf("memory operation     = %s\n", e.operation());
+    printf("link placement       = %s\n", e.link());
+    printf("experiments          = %lld\n", e.experiments);
+    printf("cold                 = %s\n", e.cold ? "yes" : "no");
+    printf("shared chain         = %s\n", e.shared_chain ? "yes" : "no");
+    printf("page backing         = %s\n", e.backing());
+    printf("backing page size    = %lld (bytes)\n", e.backing_page_size);
+    printf("huge page share      = %.3f\n", e.huge_page_share);
     printf("access pattern       = %s\n", e.access());
-    printf("stride               = %ld\n", e.stride);
+    printf("stride               = %lld\n", e.stride);
+    printf("window size          = %lld (bytes)\n", e.bytes_per_window);
+    printf("zipf exponent        = %.2f\n", e.zipf_exponent);
+    printf("hot fraction         = %.3f\n", e.hot_fraction);
+    printf("hot share            = %.3f\n", e.hot_share);
+    printf("capped lines         = %lld\n", e.capped_lines);
+    printf("effective hot share  = %.3f\n", e.effective_share);
+    printf("skipped trace visits = %lld\n", e.trace_skipped);
+    printf("page order           = %s", order_string(e.page_order));
+    if (e.page_order == Experiment::ORDER_STRIDED)
+        printf(" %lld", e.page_stride);
+    printf("\n");
+    printf("line order           = %s", order_string(e.line_order));
+    if (e.line_order == Experiment::ORDER_STRIDED)
+        printf(" %lld", e.line_stride);
+    printf("\n");
     printf("numa placement       = %s\n", e.placement());
-    printf("offset or mask       = %ld\n", e.offset_or_mask);
-    printf("numa domains         = %ld\n", e.num_numa_domains);
+    printf("offset or mask       = %lld\n", e.offset_or_mask);
+    if (e.numa_placement == Experiment::INTERLEAVE)
+        printf("interleave nodes     = \"%s\"\n", e.placement_map);
+    printf("memory policy        = %s\n", e.policy());
+    printf("misplaced pages      = %lld of %lld\n", e.pages_misplaced, e.pages_checked);
+    printf("memory tier          = %s\n", e.tier());
+    printf("numa domains         = %d\n", e.num_numa_domains);
     printf("domain map           = ");
     printf("\"");
     printf("%d:", e.thread_domain[0]);
@@ -151,13 +243,270 @@ void Output::table(Experiment &e, int64 ops, double secs, double ck_res) {
 		}
 	}
     printf("\"\n");
-    printf("operations per chain = %ld\n", ops);
-    printf("total operations     = %ld\n", ops * e.chains_per_thread * e.num_threads);
+    printf("operations per chain = %lld\n", ops);
+    printf("total operations     = %lld\n", ops * e.chains_per_thread * e.num_threads);
     printf("elapsed time         = %.3f (seconds)\n", secs);
     printf("elapsed time         = %.0f (timer ticks)\n", secs/ck_res);
     printf("clock resolution     = %.2f (ns)\n", ck_res * 1E9);
     printf("memory latency       = %.2f (ns)\n", (secs / (ops * e.iterations)) * 1E9);
-    printf("memory bandwidth     = %.3f (MB/s)\n", ((ops * e.iterations * e.chains_per_thread * e.num_threads * e.bytes_per_line) / secs) * 1E-6);
+    printf("hop rate             = %.3f (Mhops/s)\n", ((ops * e.iterations * e.chains_per_thread * e.num_threads) / secs) * 1E-6);
+    printf("memory bandwidth     = %.3f (MB/s)\n", ((ops * e.iterations * e.chains_per_thread * e.num_threads * e.bytes_per_line * e.lines_read()) / secs) * 1E-6);
+    printf("incl. write-back     = %.3f (MB/s)\n", ((ops * e.iterations * e.chains_per_thread * e.num_threads * e.bytes_per_line * (e.lines_read() + e.lines_written())) / secs) * 1E-6);
+
+    fflush(stdout);
+}
+
+void Output::print(Experiment &e, const std::vector<Stream> &streams) {
+	if (e.output_mode == Experiment::HEADER) {
+		Output::stream_header(e);
+	} else if (e.output_mode == Experiment::CSV) {
+		for (size_t i = 0; i < streams.size(); i++)
+			for (size_t j = 0; j < streams[i].seconds.size(); j++)
+				Output::stream_csv(e, streams[i], streams[i].seconds[j]);
+	} else if (e.output_mode == Experiment::BOTH) {
+		Output::stream_header(e);
+		for (size_t i = 0; i < streams.size(); i++)
+			for (size_t j = 0; j < streams[i].seconds.size(); j++)
+				Output::stream_csv(e, streams[i], streams[i].seconds[j]);
+	} else {
+		Output::stream_table(e, streams);
+	}
+}
+
+void Output::stream_header(Experiment &e) {
+    printf("cache line size (bytes),");
+    printf("chain size (bytes),");
+    printf("thread size (bytes),");
+    printf("test size (bytes),");
+    printf("chains per thread,");
+    printf("number of threads,");
+    printf("experiments,");
+    printf("store instruction,");
+    printf("iterations,");
+    printf("elapsed time (seconds),");
+    printf("store bandwidth (MB/s)\n");
+
+    fflush(stdout);
+}
+
+void Output::stream_csv(Experiment &e, const Stream &stream, double secs) {
+    printf("%lld,", e.bytes_per_line);
+    printf("%lld,", e.bytes_per_chain);
+    printf("%lld,", e.bytes_per_thread);
+    printf("%lld,", e.bytes_per_test);
+    printf("%lld,", e.chains_per_thread);
+    printf("%lld,", e.num_threads);
+    printf("%lld,", e.experiments);
+    printf("%s,", stream.store);
+    printf("%lld,", stream.iterations);
+    printf("%.3f,", secs);
+    printf("%.3f\n", ((stream.iterations * e.bytes_per_test) / secs) * 1E-6);
+
+    fflush(stdout);
+}
+
+void Output::stream_table(Experiment &e, const std::vector<Stream> &streams) {
+    printf("cache line size      = %lld (bytes)\n", e.bytes_per_line);
+    printf("chain size           = %lld (bytes)\n", e.bytes_per_chain);
+    printf("thread size          = %lld (bytes)\n", e.bytes_per_thread);
+    printf("test size            = %lld (bytes)\n", e.bytes_per_test);
+    printf("chains per thread    = %lld\n", e.chains_per_thread);
+    printf("number of threads    = %lld\n", e.num_threads);
+    printf("experiments          = %lld\n", e.experiments);
+    for (size_t i = 0; i < streams.size(); i++) {
+        long double averaged_seconds = 0;
+        for (size_t j = 0; j < streams[i].seconds.size(); j++)
+            averaged_seconds += streams[i].seconds[j];
+        averaged_seconds /= streams[i].seconds.size();
+        printf("%-20s = %.3f (MB/s)\n", streams[i].store,
+                (double) ((streams[i].iterations * e.bytes_per_test) / averaged_seconds) * 1E-6);
+    }
+
+    fflush(stdout);
+}
+
+void Output::print(Experiment &e, int64 ops, const std::vector<Sweep> &sweeps, double ck_res) {
+	if (e.output_mode == Experiment::HEADER) {
+		Output::sweep_header(e);
+	} else if (e.output_mode == Experiment::CSV) {
+		for (size_t i = 0; i < sweeps.size(); i++)
+			for (size_t j = 0; j < sweeps[i].seconds.size(); j++)
+				Output::sweep_csv(e, ops, sweeps[i], sweeps[i].seconds[j]);
+	} else if (e.output_mode == Experiment::BOTH) {
+		Output::sweep_header(e);
+		for (size_t i = 0; i < sweeps.size(); i++)
+			for (size_t j = 0; j < sweeps[i].seconds.size(); j++)
+				Output::sweep_csv(e, ops, sweeps[i], sweeps[i].seconds[j]);
+	} else {
+		Output::sweep_table(e, ops, sweeps);
+	}
+}
+
+void Output::sweep_header(Experiment &e) {
+    printf("cache line size (bytes),");
+    printf("chain size (bytes),");
+    printf("chains per thread,");
+    printf("number of threads,");
+    printf("prefetch hint,");
+    printf("memory operation,");
+    printf("experiments,");
+    printf("prefetch distance,");
+    printf("iterations,");
+    printf("elapsed time (seconds),");
+    printf("memory latency (ns),");
+    printf("hop rate (Mhops/s)\n");
+
+    fflush(stdout);
+}
+
+void Output::sweep_csv(Experiment &e, int64 ops, const Sweep &sweep, double secs) {
+    printf("%lld,", e.bytes_per_line);
+    printf("%lld,", e.bytes_per_chain);
+    printf("%lld,", e.chains_per_thread);
+    printf("%lld,", e.num_threads);
+    printf("%s,", prefetch_hint_string(e.prefetch_hint));
+    printf("%s,", e.operation());
+    printf("%lld,", e.experiments);
+    printf("%lld,", sweep.distance);
+    printf("%lld,", sweep.iterations);
+    printf("%.3f,", secs);
+    printf("%.2f,", (secs / (ops * sweep.iterations)) * 1E9);
+    printf("%.3f\n", ((ops * sweep.iterations * e.chains_per_thread * e.num_threads) / secs) * 1E-6);
+
+    fflush(stdout);
+}
+
+void Output::sweep_table(Experiment &e, int64 ops, const std::vector<Sweep> &sweeps) {
+    printf("cache line size      = %lld (bytes)\n", e.bytes_per_line);
+    printf("chain size           = %lld (bytes)\n", e.bytes_per_chain);
+    printf("chains per thread    = %lld\n", e.chains_per_thread);
+    printf("number of threads    = %lld\n", e.num_threads);
+    printf("prefetch hint        = %s\n", prefetch_hint_string(e.prefetch_hint));
+    printf("memory operation     = %s\n", e.operation());
+    printf("experiments          = %lld\n", e.experiments);
+    int64 best = -1;
+    double best_latency = 0;
+    for (size_t i = 0; i < sweeps.size(); i++) {
+        long double averaged_seconds = 0;
+        for (size_t j = 0; j < sweeps[i].seconds.size(); j++)
+            averaged_seconds += sweeps[i].seconds[j];
+        averaged_seconds /= sweeps[i].seconds.size();
+        double latency = (double) (averaged_seconds / (ops * sweeps[i].iterations)) * 1E9;
+        printf("distance %-11lld = %.2f (ns)\n", sweeps[i].distance, latency);
+        if (best < 0 || latency < best_latency) {
+            best = sweeps[i].distance;
+            best_latency = latency;
+        }
+    }
+    printf("optimal distance     = %lld\n", best);
+
+    fflush(stdout);
+}
+
+void Output::print(Experiment &e, const std::vector<Pair> &pairs) {
+	if (e.output_mode == Experiment::HEADER) {
+		Output::pair_header(e);
+	} else if (e.output_mode == Experiment::CSV) {
+		for (size_t i = 0; i < pairs.size(); i++)
+			Output::pair_csv(e, pairs[i]);
+	} else if (e.output_mode == Experiment::BOTH) {
+		Output::pair_header(e);
+		for (size_t i = 0; i < pairs.size(); i++)
+			Output::pair_csv(e, pairs[i]);
+	} else {
+		Output::matrix_table(e, pairs);
+	}
+}
+
+void Output::pair_header(Experiment &e) {
+    printf("cache line size (bytes),");
+    printf("chain size (bytes),");
+    printf("chains per thread,");
+    printf("chase engine,");
+    printf("memory operation,");
+    printf("memory policy,");
+    printf("experiments,");
+    printf("cpu domain,");
+    printf("memory domain,");
+    printf("memory tier,");
+    printf("bandwidth threads,");
+    printf("memory latency (ns),");
+    printf("memory bandwidth (MB/s)\n");
+
+    fflush(stdout);
+}
+
+void Output::pair_csv(Experiment &e, const Pair &pair) {
+    printf("%lld,", e.bytes_per_line);
+    printf("%lld,", e.bytes_per_chain);
+    printf("%lld,", e.chains_per_thread);
+    printf("%s,", e.engine());
+    printf("%s,", e.operation());
+    printf("%s,", e.policy());
+    printf("%lld,", e.experiments);
+    printf("%d,", pair.cpu_domain);
+    printf("%d,", pair.memory_domain);
+    printf("%s,", pair.tier);
+    printf("%lld,", pair.threads);
+    printf("%.2f,", pair.latency);
+    printf("%.3f\n", pair.bandwidth);
+
+    fflush(stdout);
+}
+
+void Output::matrix_table(Experiment &e, const std::vector<Pair> &pairs) {
+    printf("cache line size      = %lld (bytes)\n", e.bytes_per_line);
+    printf("chain size           = %lld (bytes)\n", e.bytes_per_chain);
+    printf("chains per thread    = %lld\n", e.chains_per_thread);
+    printf("chase engine         = %s\n", e.engine());
+    printf("memory operation     = %s\n", e.operation());
+    printf("memory policy        = %s\n", e.policy());
+    printf("experiments          = %lld\n", e.experiments);
+
+    // pairs are ordered by cpu domain, then by memory domain
+    int rows = e.num_cpu_domains;
+    int columns = e.num_memory_domains;
+    printf("\nmemory latency (ns), cpu domain by memory domain\n");
+    printf("%8s", "");
+    for (int j = 0; j < columns; j++)
+        printf(" %10d", e.memory_domains[j]);
+    printf("\n");
+    for (int i = 0; i < rows; i++) {
+        printf("%8d", e.cpu_domains[i]);
+        for (int j = 0; j < columns; j++)
+            printf(" %10.2f", pairs[i * columns + j].latency);
+        printf("\n");
+    }
+
+    printf("\nmemory bandwidth (MB/s), cpu domain by memory domain\n");
+    printf("%8s", "");
+    for (int j = 0; j < columns; j++)
+        printf(" %10d", e.memory_domains[j]);
+    printf("\n");
+    for (int i = 0; i < rows; i++) {
+        printf("%8d", e.cpu_domains[i]);
+        for (int j = 0; j < columns; j++)
+            printf(" %10.1f", pairs[i * columns + j].bandwidth);
+        printf("\n");
+    }
+
+    // averages over all pairs of each tier
+    printf("\n");
+    const char* tiers[] = { "local", "remote", "cpu-less" };
+    for (int t = 0; t < 3; t++) {
+        int count = 0;
+        double latency = 0, bandwidth = 0;
+        for (size_t i = 0; i < pairs.size(); i++) {
+            if (strcmp(pairs[i].tier, tiers[t]) == 0) {
+                count++;
+                latency += pairs[i].latency;
+                bandwidth += pairs[i].bandwidth;
+            }
+        }
+        if (0 < count)
+            printf("%-8s tier        = %.2f (ns), %.1f (MB/s)\n", tiers[t],
+                    latency / count, bandwidth / count);
+    }
 
     fflush(stdout);
 }
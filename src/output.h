@@ -24,6 +24,7 @@
 // Local includes
 #include "types.h"
 #include "experiment.h"
+#include "run.h"
 
 
 //
@@ -36,6 +37,21 @@ public:
 	static void header(Experiment &e, int64 ops, double ck_res);
 	static void csv(Experiment &e, int64 ops, double seconds, double ck_res);
 	static void table(Experiment &e, int64 ops, double seconds, double ck_res);
+
+	static void print(Experiment &e, const std::vector<Stream> &streams);
+	static void stream_header(Experiment &e);
+	static void stream_csv(Experiment &e, const Stream &stream, double seconds);
+	static void stream_table(Experiment &e, const std::vector<Stream> &streams);
+
+	static void print(Experiment &e, int64 ops, const std::vector<Sweep> &sweeps, double ck_res);
+	static void sweep_header(Experiment &e);
+	static void sweep_csv(Experiment &e, int64 ops, const Sweep &sweep, double seconds);
+	static void sweep_table(Experiment &e, int64 ops, const std::vector<Sweep> &sweeps);
+
+	static void print(Experiment &e, const std::vector<Pair> &pairs);
+	static void pair_header(Experiment &e);
+	static void pair_csv(Experiment &e, const Pair &pair);
+	static void matrix_table(Experiment &e, const std::vector<Pair> &pairs);
 private:
 };
 
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * Copyright (c) 2006 International Business Machines Corporation.             *
+ * All rights reserved. This program and the accompanying materials            *
+ * are made available under the terms of the Common Public License v1.0        *
+ * which accompanies this distribution, and is available at                    *
+ * http://www.opensource.org/licenses/cpl1.0.php                               *
+ *                                                                             *
+ * Contributors:                                                               *
+ *    Douglas M. Pase - initial API and implementation                         *
+ *    Tim Besard - prefetching, JIT compilation                                *
+ *******************************************************************************/
+
+//
+// Configuration
+//
+
+// Implementation header
+#include "random.h"
+
+
+//
+// Implementation
+//
+
+static inline uint64 rotl(uint64 x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+Random::Random(uint64 seed) {
+	this->seed(seed);
+}
+
+Random::~Random() {
+}
+
+void Random::seed(uint64 seed) {
+	// expand the seed with splitmix64, which
+	// never yields an all-zero state
+	for (int i = 0; i < 4; i++) {
+		seed += 0x9E3779B97F4A7C15ULL;
+		uint64 z = seed;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		this->state[i] = z ^ (z >> 31);
+	}
+}
+
+uint64 Random::next() {
+	uint64 result = rotl(this->state[1] * 5, 7) * 9;
+	uint64 t = this->state[1] << 17;
+
+	this->state[2] ^= this->state[0];
+	this->state[3] ^= this->state[1];
+	this->state[1] ^= this->state[2];
+	this->state[0] ^= this->state[3];
+
+	this->state[2] ^= t;
+	this->state[3] = rotl(this->state[3], 45);
+
+	return result;
+}
+
+uint64 Random::uniform(uint64 n) {
+	// multiply-shift reduction, free of the
+	// modulo bias for the ranges used here
+	return (uint64) (((unsigned __int128) this->next() * n) >> 64);
+}
+
+double Random::real() {
+	// the upper 53 bits, scaled to [0, 1)
+	return (this->next() >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,44 @@
+/*******************************************************************************
+ * Copyright (c) 2006 International Business Machines Corporation.             *
+ * All rights reserved. This program and the accompanying materials            *
+ * are made available under the terms of the Common Public License v1.0        *
+ * which accompanies this distribution, and is available at                    *
+ * http://www.opensource.org/licenses/cpl1.0.php                               *
+ *                                                                             *
+ * Contributors:                                                               *
+ *    Douglas M. Pase - initial API and implementation                         *
+ *    Tim Besard - prefetching, JIT compilation                                *
+ *******************************************************************************/
+
+//
+// Configuration
+//
+
+// Include guard
+#if !defined(RANDOM_H)
+#define RANDOM_H
+
+// Local includes
+#include "types.h"
+
+
+//
+// Class definition
+//
+
+// xoshiro256** generator. Every thread owns its own
+// instance, so unlike random() no lock is needed.
+class Random {
+public:
+	Random(uint64 seed = 0);
+	~Random();
+	void seed(uint64 seed);
+	uint64 next();
+	uint64 uniform(uint64 n);
+	double real();
+
+private:
+	uint64 state[4];
+};
+
+#endif
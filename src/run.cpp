@@ -30,26 +30,92 @@
 // Local includes
 #include <AsmJit/AsmJit.h>
 #include "timer.h"
+#include "native.h"
+#include "memory.h"
 
 
 //
 // Implementation
 //
 
-typedef void (*benchmark)(const Chain**);
-typedef benchmark (*generator)(int64 chains_per_thread,
-		int64 bytes_per_line, int64 bytes_per_chain,
-		int64 stride, int64 loop_length, int32 prefetch_hint);
-static benchmark chase_pointers(int64 chains_per_thread,
-		int64 bytes_per_line, int64 bytes_per_chain,
-		int64 stride, int64 loop_length, int32 prefetch_hint);
+typedef benchmark (*generator)(Experiment &e, int64 ops_per_chain);
+static benchmark chase_pointers(Experiment &e, int64 ops_per_chain);
+static benchmark chase_gather(Experiment &e, int64 ops_per_chain);
+static benchmark chase_native(Experiment &e, int64 ops_per_chain);
+static benchmark stream_stores(Experiment &e, int32 store);
+
+// store instructions compared by the stream engine
+enum { MOV, MOVDQA, MOVNTI, MOVNTDQ, MOVNTPS, REP_STOSB };
+static const char* store_names[] = { "mov", "movdqa", "movnti", "movntdq",
+		"movntps", "rep stosb", };
+static const int store_count = sizeof store_names / sizeof store_names[0];
+
+// Beyond this amount of chains the cursors no longer fit in the
+// general purpose registers, and the compiler would start spilling
+// some of them to the stack.
+static const int64 MAX_REGISTER_CHAINS = 12;
+
+// size of the cache lines of this processor, as opposed
+// to the lines the chains are made of
+static int64 cache_line_size() {
+	int64 size = AsmJit::getCpuInfo()->x86ExtendedInfo.flushCacheLineSize;
+	if (size == 0)
+		size = Experiment::DEFAULT_BYTES_PER_LINE;
+	return size;
+}
+
+// benchmark shared by all threads
+static benchmark shared_bench = 0;
+
+// memory of the chain shared by all threads, and
+// the root of the segment built by each chain
+static Chain* shared_chain = 0;
+static std::vector<Chain*> shared_roots;
+static std::vector<int64> shared_hops;
+
+// number of hops it takes to get back to root, or more
+// than limit when root is not reached within limit hops
+static int64 cycle_length(const Chain* root, int64 limit) {
+	int64 hops = 1;
+	for (const Chain* p = root->next; p != root && hops <= limit; p = p->next) {
+		hops++;
+	}
+	return hops;
+}
+
+// map the memory of a chain, including the spare line
+// links straddling the end of its last line reach into
+static Chain* map_chain(Experiment &e) {
+	int64 bytes = (e.links_per_chain + e.links_per_line) * sizeof(Chain);
+	Chain* memory = Memory::allocate(bytes, e.page_backing);
+	if (memory == NULL) {
+		fprintf(stderr, "chase: unable to map %lld bytes of %s pages\n", bytes, e.backing());
+		exit(1);
+	}
+	return memory;
+}
+
+static void unmap_chain(Experiment &e, Chain* memory) {
+	int64 bytes = (e.links_per_chain + e.links_per_line) * sizeof(Chain);
+	Memory::release(memory, bytes, e.page_backing);
+}
 
 Lock Run::global_mutex;
 int64 Run::_ops_per_chain = 0;
 std::vector<double> Run::_seconds;
+std::vector<Stream> Run::_streams;
+std::vector<Sweep> Run::_sweeps;
+
+// forget the results of earlier runs
+void Run::reset() {
+	Run::_ops_per_chain = 0;
+	Run::_seconds.clear();
+	Run::_streams.clear();
+	Run::_sweeps.clear();
+}
 
 Run::Run() :
-		exp(NULL), bp(NULL) {
+		exp(NULL), bp(NULL), chain_memory(NULL) {
 }
 
 Run::~Run() {
@@ -61,11 +127,29 @@ void Run::set(Experiment &e, SpinBarrier* sbp) {
 }
 
 int Run::run() {
+	// seed the generator of this thread, so
+	// chains are reproducible from run to run
+	this->rng.seed(this->thread_id());
+
 	// first allocate all memory for the chains,
 	// making sure it is allocated within the
 	// intended numa domains
 	Chain** chain_memory = new Chain*[this->exp->chains_per_thread];
-	Chain** root = new Chain*[this->exp->chains_per_thread];
+	this->chain_memory = chain_memory;
+	// the roots double as the cursors of the wide kernel, so
+	// keep them on cache lines of their own to avoid false
+	// sharing with the roots of other threads. lines need
+	// not be a power of two, so align to the next one up.
+	Chain** root = NULL;
+	int64 root_align = sizeof(Chain*);
+	while (root_align < this->exp->bytes_per_line)
+		root_align *= 2;
+	int64 root_bytes = ((this->exp->chains_per_thread * sizeof(Chain*)
+			+ root_align - 1) / root_align) * root_align;
+	if (posix_memalign((void**) &root, root_align, root_bytes) != 0) {
+		fprintf(stderr, "chase: unable to allocate %lld bytes of chain roots\n", root_bytes);
+		::exit(1);
+	}
 
 #if defined(NUMA)
 	// establish the node id where this thread
@@ -73,101 +157,332 @@ int Run::run() {
 	// by the set-up code for Experiment.
 	int run_node_id = this->exp->thread_domain[this->thread_id()];
 	numa_run_on_node(run_node_id);
+#endif
 
-	// establish the node id where this thread's
-	// memory will be allocated.
-	for (int i=0; i < this->exp->chains_per_thread; i++) {
-		int alloc_node_id = this->exp->chain_domain[this->thread_id()][i];
-		nodemask_t alloc_mask;
-		nodemask_zero(&alloc_mask);
-		nodemask_set(&alloc_mask, alloc_node_id);
-		numa_set_membind(&alloc_mask);
+	// map the chains. nothing is faulted in yet, so
+	// the policy of each chain applies to all its pages.
+	for (int i = 0; i < this->exp->chains_per_thread && !this->exp->shared_chain; i++) {
+		chain_memory[i] = map_chain(*this->exp);
+	}
 
-		chain_memory[i] = new Chain[ this->exp->links_per_chain ];
+	// a shared chain is allocated once, and every chain
+	// of every thread is a segment of it, placed as if
+	// it were a chain of its own.
+	int64 segment = this->thread_id() * this->exp->chains_per_thread;
+	if (this->exp->shared_chain) {
+		this->bp->barrier();
+		if (this->thread_id() == 0) {
+			shared_chain = map_chain(*this->exp);
+			shared_roots.resize(this->exp->num_threads * this->exp->chains_per_thread);
+			shared_hops.resize(this->exp->num_threads * this->exp->chains_per_thread);
+		}
+		this->bp->barrier();
+		for (int i = 0; i < this->exp->chains_per_thread; i++) {
+			chain_memory[i] = shared_chain + (segment + i)
+					* this->exp->pages_per_segment * this->exp->links_per_page;
+		}
 	}
-#else
+
+	// bind every chain to the numa domains of its policy,
+	// fault it in, and verify where its pages ended up.
+	// all threads do so in parallel, each for its chains.
+	int64 chain_bytes = this->exp->shared_chain
+			? this->exp->pages_per_segment * this->exp->links_per_page * sizeof(Chain)
+			: (this->exp->links_per_chain + this->exp->links_per_line) * sizeof(Chain);
+	int64 checked = 0, misplaced = 0;
+	// pages interleaved across an explicit list of domains
+	// are spread round-robin by the kernel first, then
+	// moved to their own domain one by one.
+	bool interleave = this->exp->numa_placement == Experiment::INTERLEAVE;
+	int32 policy = interleave ? (int32) Experiment::POLICY_INTERLEAVE : (int32) this->exp->numa_policy;
+	std::vector<int32> sequence(this->exp->interleave_nodes,
+			this->exp->interleave_nodes + this->exp->interleave_length);
 	for (int i = 0; i < this->exp->chains_per_thread; i++) {
-		chain_memory[i] = new Chain[this->exp->links_per_chain];
+		std::vector<int32> nodes;
+		if (interleave) {
+			nodes = sequence;
+			std::sort(nodes.begin(), nodes.end());
+			nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+		} else if (policy == Experiment::POLICY_INTERLEAVE) {
+			nodes.assign(this->exp->memory_domains,
+					this->exp->memory_domains + this->exp->num_memory_domains);
+		} else {
+			nodes.push_back(this->exp->chain_domain[this->thread_id()][i]);
+		}
+
+		if (Memory::bind(chain_memory[i], chain_bytes, this->exp->page_backing,
+				policy, nodes) != 0) {
+			fprintf(stderr, "chase: unable to bind chain %d of thread %d to domain %d\n",
+					i, this->thread_id(), nodes[0]);
+		}
+		Memory::prefault(chain_memory[i], chain_bytes, this->exp->page_backing,
+				this->exp->bytes_per_line);
+
+		int64 n = 0;
+		if (interleave) {
+			misplaced += Memory::distribute(chain_memory[i], chain_bytes,
+					this->exp->page_backing, sequence, n);
+		} else {
+			misplaced += Memory::misplaced(chain_memory[i], chain_bytes,
+					this->exp->page_backing, nodes, n);
+		}
+		checked += n;
 	}
-#endif
+	Run::global_mutex.lock();
+	this->exp->pages_checked += checked;
+	this->exp->pages_misplaced += misplaced;
+	Run::global_mutex.unlock();
 
 	// initialize the chains and
 	// select the function that
 	// will generate the tests
 	generator gen;
+	int64 pages = this->exp->pages_per_segment;
 	for (int i = 0; i < this->exp->chains_per_thread; i++) {
 		if (this->exp->access_pattern == Experiment::RANDOM) {
-			root[i] = random_mem_init(chain_memory[i]);
-			gen = chase_pointers;
+			root[i] = random_mem_init(chain_memory[i], pages);
+		} else if (this->exp->access_pattern == Experiment::PERMUTE) {
+			root[i] = permute_mem_init(chain_memory[i], pages);
+		} else if (this->exp->access_pattern == Experiment::PERMUTE_PAGES) {
+			root[i] = permute_pages_mem_init(chain_memory[i], pages);
+		} else if (this->exp->access_pattern == Experiment::ORDERED) {
+			root[i] = ordered_mem_init(chain_memory[i], pages);
+		} else if (this->exp->access_pattern == Experiment::WINDOW) {
+			root[i] = window_mem_init(chain_memory[i], pages);
+		} else if (this->exp->access_pattern == Experiment::ZIPF
+				|| this->exp->access_pattern == Experiment::HOTCOLD) {
+			root[i] = skewed_mem_init(chain_memory[i], pages);
+		} else if (this->exp->access_pattern == Experiment::TRACE) {
+			root[i] = trace_mem_init(chain_memory[i], pages);
 		} else if (this->exp->access_pattern == Experiment::STRIDED) {
 			if (0 < this->exp->stride) {
-				root[i] = forward_mem_init(chain_memory[i]);
+				root[i] = forward_mem_init(chain_memory[i], pages);
 			} else {
-				root[i] = reverse_mem_init(chain_memory[i]);
+				root[i] = reverse_mem_init(chain_memory[i], pages);
 			}
-			gen = chase_pointers;
 		}
 	}
 
-	// compile benchmark
-	benchmark bench = gen(this->exp->chains_per_thread,
-			this->exp->bytes_per_line, this->exp->bytes_per_chain,
-			this->exp->stride, this->exp->loop_length,
-			this->exp->prefetch_hint);
-
-	// calculate the number of iterations
-	/*
-	 * As soon as the thread count rises, this calculation HUGELY
-	 * differs between runs. What does cause this? Threads are already
-	 * limited to certain CPUs, so it's not caused by excessive switching.
-	 * Strange cache behaviour?
-	 */
-	if (0 == this->exp->iterations) {
-		volatile static double istart = 0;
-		volatile static double istop = 0;
-		volatile static double elapsed = 0;
-		volatile static int64 iters = 1;
-		volatile double bound = std::max(0.2, 10 * Timer::resolution());
-		for (iters = 1; elapsed <= bound; iters = iters << 1) {
-			// barrier
-			this->bp->barrier();
+	// report the pages the kernel actually backed the
+	// chains with, now that the builders touched them
+	this->bp->barrier();
+	if (this->thread_id() == 0) {
+		this->exp->backing_page_size = Memory::backing(chain_memory[0],
+				this->exp->huge_page_share);
+	}
+
+	// stitch the segments into a single cycle. exchanging
+	// the successors of two links on disjoint cycles joins
+	// them, so each segment in turn is spliced in after
+	// the root of the one before it. the hops of the cycle
+	// are those of all segments, which some patterns vary.
+	if (this->exp->shared_chain) {
+		for (int i = 0; i < this->exp->chains_per_thread; i++) {
+			shared_roots[segment + i] = root[i];
+			shared_hops[segment + i] = cycle_length(root[i],
+					this->exp->pages_per_segment * this->exp->links_per_page);
+		}
+		this->bp->barrier();
+		if (this->thread_id() == 0) {
+			int64 segments = this->exp->num_threads * this->exp->chains_per_thread;
+			for (int64 k = 0; k + 1 < segments; k++) {
+				Chain* t = shared_roots[k]->next;
+				shared_roots[k]->next = shared_roots[k + 1]->next;
+				shared_roots[k + 1]->next = t;
+			}
+			Run::_ops_per_chain = 0;
+			for (int64 k = 0; k < segments; k++) {
+				Run::_ops_per_chain += shared_hops[k];
+			}
+		}
+		this->bp->barrier();
+	}
+
+	// walk every chain once, to make sure it closes into
+	// a single cycle through all the links it was built of
+	if (this->exp->check) {
+		this->bp->barrier();
+		for (int i = 0; i < this->exp->chains_per_thread; i++) {
+			int64 hops = cycle_length(root[i], Run::_ops_per_chain);
+			if (hops != Run::_ops_per_chain) {
+				fprintf(stderr, "chase: chain %d of thread %d is not a cycle of %lld links\n",
+						i, this->thread_id(), Run::_ops_per_chain);
+				::exit(1);
+			}
+		}
+	}
 
-			// start timer
+	// the stream engine overwrites the chains with each
+	// of the store instructions in turn, rather than
+	// chasing them
+	if (this->exp->chase_engine == Experiment::STREAM) {
+		for (int k = 0; k < store_count; k++) {
+			this->bp->barrier();
 			if (this->thread_id() == 0) {
-				istart = Timer::seconds();
+				Stream result;
+				result.store = store_names[k];
+				result.iterations = this->exp->iterations;
+				Run::_streams.push_back(result);
+				shared_bench = stream_stores(*this->exp, k);
 			}
 			this->bp->barrier();
+			benchmark bench = shared_bench;
+			if (bench == 0) {
+				return 1;
+			}
 
-			// chase pointers
-			for (int i = 0; i < iters; i++)
-				bench((const Chain**) root);
+			this->measure(bench, (const Chain**) chain_memory,
+					Run::_streams[k].iterations, Run::_streams[k].seconds);
 
-			// barrier
 			this->bp->barrier();
-
-			// stop timer
 			if (this->thread_id() == 0) {
-				istop = Timer::seconds();
-				elapsed = istop - istart;
+				AsmJit::MemoryManager::getGlobal()->free((void*) bench);
+				shared_bench = 0;
+			}
+		}
+	} else if (this->exp->prefetch_sweep) {
+		// the sweep recompiles the scalar benchmark
+		// for each prefetch distance in turn
+		for (int64 d = 0; d <= Experiment::MAX_PREFETCH_DISTANCE; d = (d == 0) ? 1 : 2 * d) {
+			int k = Run::_sweeps.size();
+			this->bp->barrier();
+			if (this->thread_id() == 0) {
+				Sweep result;
+				result.distance = d;
+				result.iterations = this->exp->iterations;
+				Run::_sweeps.push_back(result);
+				this->exp->prefetch_distance = d;
+				shared_bench = chase_pointers(*this->exp, Run::_ops_per_chain);
 			}
 			this->bp->barrier();
+			benchmark bench = shared_bench;
+			if (bench == 0) {
+				return 1;
+			}
+
+			this->measure(bench, (const Chain**) root,
+					Run::_sweeps[k].iterations, Run::_sweeps[k].seconds);
+
+			this->bp->barrier();
+			if (this->thread_id() == 0) {
+				AsmJit::MemoryManager::getGlobal()->free((void*) bench);
+				shared_bench = 0;
+			}
+		}
+	} else {
+		if (this->exp->chase_engine == Experiment::GATHER) {
+			gen = chase_gather;
+		} else if (this->exp->chase_engine == Experiment::NATIVE) {
+			gen = chase_native;
+		} else {
+			gen = chase_pointers;
+		}
+
+		// compile the benchmark once all chains are
+		// initialized, and share it with all threads
+		this->bp->barrier();
+		if (this->thread_id() == 0) {
+			shared_bench = gen(*this->exp, Run::_ops_per_chain);
+		}
+		this->bp->barrier();
+		benchmark bench = shared_bench;
+		if (bench == 0) {
+			return 1;
+		}
+
+		// calibrate and run the experiments
+		this->measure(bench, (const Chain**) root, this->exp->iterations, Run::_seconds);
+
+		this->bp->barrier();
+
+		// release the benchmark, unless it
+		// is part of the executable itself
+		if (this->thread_id() == 0) {
+			if (this->exp->chase_engine != Experiment::NATIVE) {
+				AsmJit::MemoryManager::getGlobal()->free((void*) bench);
+			}
+			shared_bench = 0;
+		}
+	}
+
+	// clean the memory
+	if (this->exp->shared_chain) {
+		this->bp->barrier();
+		if (this->thread_id() == 0) {
+			unmap_chain(*this->exp, shared_chain);
+			shared_chain = 0;
+		}
+	}
+	for (int i = 0; i < this->exp->chains_per_thread && !this->exp->shared_chain; i++) {
+		if (chain_memory[i] != NULL
+			) unmap_chain(*this->exp, chain_memory[i]);
+	}
+	if (chain_memory != NULL
+		) delete[] chain_memory;
+	if (root != NULL
+		) free(root);
+
+	return 0;
+}
+
+void Run::measure(benchmark bench, const Chain** arg, int64 &iterations,
+		std::vector<double> &seconds) {
+	// calculate the number of iterations. every thread
+	// doubles its own copy of the trial count, and only
+	// the elapsed time is shared through thread 0.
+	if (0 == iterations) {
+		int64 iters = 1;
+		double elapsed = 0;
+		volatile double bound = std::max(0.2, 10 * Timer::resolution());
+		for (iters = 1; elapsed <= bound; iters = iters << 1) {
+			elapsed = this->timed(bench, arg, iters);
 		}
 
 		// calculate the number of iterations
 		if (this->thread_id() == 0) {
 			if (0 < this->exp->seconds) {
-				this->exp->iterations = std::max(1.0,
+				iterations = std::max(1.0,
 						0.9999 + 0.5 * this->exp->seconds * iters / elapsed);
 			} else {
-				this->exp->iterations = std::max(1.0, 0.9999 + iters / elapsed);
+				iterations = std::max(1.0, 0.9999 + iters / elapsed);
 			}
-			//printf("Tested %d iterations: took %f seconds; scheduling %d iterations\n", iters, elapsed, this->exp->iterations);
 		}
 		this->bp->barrier();
 	}
 
 	// run the experiments
 	for (int e = 0; e < this->exp->experiments; e++) {
+		double delta = this->timed(bench, arg, iterations);
+
+		if (0 <= e) {
+			if (this->thread_id() == 0) {
+				if (0 < delta) {
+					seconds.push_back(delta);
+				}
+			}
+		}
+	}
+}
+
+double Run::timed(benchmark bench, const Chain** arg, int64 iterations) {
+	volatile static double elapsed = 0;
+
+	// cold runs flush the chains before every iteration,
+	// and only time the iterations themselves
+	int64 rounds = this->exp->cold ? iterations : 1;
+	int64 iters = this->exp->cold ? 1 : iterations;
+
+	// barrier
+	this->bp->barrier();
+	if (this->thread_id() == 0) {
+		elapsed = 0;
+	}
+
+	for (int64 r = 0; r < rounds; r++) {
+		if (this->exp->cold) {
+			this->flush();
+		}
+
 		// barrier
 		this->bp->barrier();
 
@@ -177,40 +492,74 @@ int Run::run() {
 			start = Timer::seconds();
 		this->bp->barrier();
 
-		// chase pointers
-		for (int i = 0; i < this->exp->iterations; i++)
-			bench((const Chain**) root);
+		// run the benchmark
+		for (int64 i = 0; i < iters; i++)
+			bench(arg);
 
 		// barrier
 		this->bp->barrier();
 
 		// stop timer
-		double stop = 0;
 		if (this->thread_id() == 0)
-			stop = Timer::seconds();
-		this->bp->barrier();
-
-		if (0 <= e) {
-			if (this->thread_id() == 0) {
-				double delta = stop - start;
-				if (0 < delta) {
-					Run::_seconds.push_back(delta);
-				}
-			}
-		}
+			elapsed = elapsed + Timer::seconds() - start;
 	}
-
 	this->bp->barrier();
 
-	// clean the memory
+	return elapsed;
+}
+
+void Run::flush() {
+	// evict every line of every chain of this
+	// thread from all levels of the cache, using
+	// the weakly ordered variant when available
+	AsmJit::CpuInfo* cpu = AsmJit::getCpuInfo();
+	bool opt = cpu->extendedFeatures & AsmJit::CPU_EXTENDED_FEATURE_CLFLUSHOPT;
+	int64 step = cache_line_size();
+
 	for (int i = 0; i < this->exp->chains_per_thread; i++) {
-		if (chain_memory[i] != NULL
-			) delete[] chain_memory[i];
+		char* line = (char*) this->chain_memory[i];
+		char* end = line + this->exp->pages_per_segment * this->exp->bytes_per_page;
+		if (opt) {
+			for (; line < end; line += step)
+				__asm__ __volatile__(".byte 0x66; clflush %0" : "+m" (*line));
+		} else {
+			for (; line < end; line += step)
+				__asm__ __volatile__("clflush %0" : "+m" (*line));
+		}
 	}
-	if (chain_memory != NULL
-		) delete[] chain_memory;
+	__asm__ __volatile__("mfence" ::: "memory");
+}
 
-	return 0;
+// scramble the bits of x (the splitmix64 finalizer)
+static inline uint64 mix(uint64 x) {
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+// the link of the line starting at mem + link. random
+// offsets are a function of the line, so the builders
+// can place the link of a line more than once.
+Chain* Run::place(Chain *mem, int64 link) {
+	char* line = (char*) (mem + link);
+	int64 word = this->exp->pointer_size;
+
+	switch (this->exp->link_placement) {
+	case Experiment::LINK_LAST:
+		return (Chain*) (line + this->exp->bytes_per_stride - word);
+	case Experiment::LINK_RANDOM: {
+		// leave the word after each link to the payload
+		int64 step = (this->exp->memory_operation == Experiment::LOAD) ? 1 : 2;
+		int64 words = this->exp->links_per_line / step;
+		return (Chain*) (line + mix(link) % words * step * word);
+	}
+	case Experiment::LINK_SPLIT_LINE:
+	case Experiment::LINK_SPLIT_PAGE:
+		return (Chain*) (line + this->exp->bytes_per_stride - word / 2);
+	case Experiment::LINK_FIRST:
+	default:
+		return (Chain*) line;
+	}
 }
 
 int dummy = 0;
@@ -228,7 +577,7 @@ static const int prime_table[] = { 5, 11, 13, 17, 19, 23, 37, 41, 43, 47, 53,
 static const int prime_table_size = sizeof prime_table / sizeof prime_table[0];
 
 Chain*
-Run::random_mem_init(Chain *mem) {
+Run::random_mem_init(Chain *mem, int64 pages) {
 	// initialize pointers --
 	// choose a page at random, then use
 	// one pointer from each cache line
@@ -236,43 +585,125 @@ Run::random_mem_init(Chain *mem) {
 	// cache lines are chosen at random.
 	Chain* root = 0;
 	Chain* prev = 0;
-	int link_within_line = 0;
 	int64 local_ops_per_chain = 0;
 
-	// we must set a lock because random()
-	// is not thread safe
+	// every thread draws from its own generator
+	int64 page_factor = prime_table[this->rng.uniform(prime_table_size)];
+	int64 page_offset = this->rng.uniform(pages);
+
+	// loop through the pages
+	for (int64 i = 0; i < pages; i++) {
+		int64 page = (page_factor * i + page_offset) % pages;
+		int64 line_factor = prime_table[this->rng.uniform(prime_table_size)];
+		int64 line_offset = this->rng.uniform(this->exp->lines_per_page);
+
+		// loop through the lines within a page
+		for (int64 j = 0; j < this->exp->lines_per_page; j++) {
+			int64 line_within_page = (line_factor * j + line_offset)
+					% this->exp->lines_per_page;
+			int64 link = page * this->exp->links_per_page
+					+ line_within_page * this->exp->links_per_line;
+
+			if (root == 0) {
+				prev = root = this->place(mem, link);
+				local_ops_per_chain += 1;
+			} else {
+				prev->next = this->place(mem, link);
+				prev = prev->next;
+				local_ops_per_chain += 1;
+			}
+		}
+	}
+
+	prev->next = root;
+
 	Run::global_mutex.lock();
-	setstate(this->exp->random_state[this->thread_id()]);
-	int page_factor = prime_table[random() % prime_table_size];
-	int page_offset = random() % this->exp->pages_per_chain;
+	Run::_ops_per_chain = local_ops_per_chain;
 	Run::global_mutex.unlock();
 
+	return root;
+}
+
+Chain*
+Run::permute_mem_init(Chain *mem, int64 pages) {
+	// initialize pointers --
+	// link every line to itself, then apply
+	// Sattolo's algorithm to the links. this
+	// yields a uniformly chosen permutation
+	// consisting of a single cycle through
+	// all lines of the chain, built in place.
+	int64 stride = this->exp->links_per_line;
+
+	int64 lines = pages * this->exp->lines_per_page;
+	for (int64 i = 0; i < lines; i++) {
+		Chain* link = this->place(mem, i * stride);
+		link->next = link;
+	}
+
+	for (int64 i = lines - 1; 0 < i; i--) {
+		int64 j = this->rng.uniform(i);
+		Chain* a = this->place(mem, i * stride);
+		Chain* b = this->place(mem, j * stride);
+		Chain* t = a->next;
+		a->next = b->next;
+		b->next = t;
+	}
+
+	Run::global_mutex.lock();
+	Run::_ops_per_chain = lines;
+	Run::global_mutex.unlock();
+
+	return this->place(mem, 0);
+}
+
+Chain*
+Run::permute_pages_mem_init(Chain *mem, int64 pages) {
+	// initialize pointers --
+	// follow a uniform random cycle through
+	// the pages (Sattolo's algorithm), and
+	// visit the lines of each page in an
+	// order shuffled anew for every page
+	// (Fisher-Yates).
+	Chain* root = 0;
+	Chain* prev = 0;
+	int64 local_ops_per_chain = 0;
+
+	std::vector<int64> next_page(pages);
+	for (int64 i = 0; i < pages; i++) {
+		next_page[i] = i;
+	}
+	for (int64 i = pages - 1; 0 < i; i--) {
+		std::swap(next_page[i], next_page[this->rng.uniform(i)]);
+	}
+
+	std::vector<int64> lines(this->exp->lines_per_page);
+	for (int64 j = 0; j < this->exp->lines_per_page; j++) {
+		lines[j] = j;
+	}
+
 	// loop through the pages
-	for (int i = 0; i < this->exp->pages_per_chain; i++) {
-		int page = (page_factor * i + page_offset) % this->exp->pages_per_chain;
-		Run::global_mutex.lock();
-		setstate(this->exp->random_state[this->thread_id()]);
-		int line_factor = prime_table[random() % prime_table_size];
-		int line_offset = random() % this->exp->lines_per_page;
-		Run::global_mutex.unlock();
+	int64 page = 0;
+	for (int64 i = 0; i < pages; i++) {
+		for (int64 j = this->exp->lines_per_page - 1; 0 < j; j--) {
+			std::swap(lines[j], lines[this->rng.uniform(j + 1)]);
+		}
 
 		// loop through the lines within a page
-		for (int j = 0; j < this->exp->lines_per_page; j++) {
-			int line_within_page = (line_factor * j + line_offset)
-					% this->exp->lines_per_page;
-			int link = page * this->exp->links_per_page
-					+ line_within_page * this->exp->links_per_line
-					+ link_within_line;
+		for (int64 j = 0; j < this->exp->lines_per_page; j++) {
+			int64 link = page * this->exp->links_per_page
+					+ lines[j] * this->exp->links_per_line;
 
 			if (root == 0) {
-				prev = root = mem + link;
+				prev = root = this->place(mem, link);
 				local_ops_per_chain += 1;
 			} else {
-				prev->next = mem + link;
+				prev->next = this->place(mem, link);
 				prev = prev->next;
 				local_ops_per_chain += 1;
 			}
 		}
+
+		page = next_page[page];
 	}
 
 	prev->next = root;
@@ -284,16 +715,181 @@ Run::random_mem_init(Chain *mem) {
 	return root;
 }
 
+// fill seq with a permutation of 0..seq.size()-1
+static void order(std::vector<int64> &seq, int32 order, int64 stride,
+		Random &rng) {
+	int64 n = seq.size();
+	int64 k = 0;
+	switch (order) {
+	case Experiment::ORDER_SEQUENTIAL:
+		for (int64 i = 0; i < n; i++)
+			seq[k++] = i;
+		break;
+	case Experiment::ORDER_REVERSE:
+		for (int64 i = n - 1; 0 <= i; i--)
+			seq[k++] = i;
+		break;
+	case Experiment::ORDER_STRIDED:
+		// every stride-th element, then every stride-th
+		// one after those, and so on, which covers all
+		// elements whatever the stride
+		for (int64 first = 0; first < stride && first < n; first++)
+			for (int64 i = first; i < n; i += stride)
+				seq[k++] = i;
+		break;
+	case Experiment::ORDER_RANDOM:
+		for (int64 i = 0; i < n; i++)
+			seq[i] = i;
+		for (int64 i = n - 1; 0 < i; i--)
+			std::swap(seq[i], seq[rng.uniform(i + 1)]);
+		break;
+	}
+}
+
 Chain*
-Run::forward_mem_init(Chain *mem) {
+Run::ordered_mem_init(Chain *mem, int64 pages) {
+	// initialize pointers --
+	// visit the pages in the page order, and
+	// the lines within each page in the line
+	// order. a random line order is drawn anew
+	// for every page.
 	Chain* root = 0;
 	Chain* prev = 0;
-	int link_within_line = 0;
 	int64 local_ops_per_chain = 0;
 
-	for (int i = 0; i < this->exp->lines_per_chain; i += this->exp->stride) {
-		int link = i * this->exp->links_per_line + link_within_line;
-		if (root == NULL) {
+	std::vector<int64> page_seq(pages);
+	order(page_seq, this->exp->page_order, this->exp->page_stride, this->rng);
+	std::vector<int64> line_seq(this->exp->lines_per_page);
+	order(line_seq, this->exp->line_order, this->exp->line_stride, this->rng);
+
+	// loop through the pages
+	for (int64 i = 0; i < pages; i++) {
+		if (0 < i && this->exp->line_order == Experiment::ORDER_RANDOM) {
+			order(line_seq, this->exp->line_order, this->exp->line_stride, this->rng);
+		}
+
+		// loop through the lines within a page
+		for (int64 j = 0; j < this->exp->lines_per_page; j++) {
+			int64 link = page_seq[i] * this->exp->links_per_page
+					+ line_seq[j] * this->exp->links_per_line;
+
+			if (root == 0) {
+				prev = root = this->place(mem, link);
+				local_ops_per_chain += 1;
+			} else {
+				prev->next = this->place(mem, link);
+				prev = prev->next;
+				local_ops_per_chain += 1;
+			}
+		}
+	}
+
+	prev->next = root;
+
+	Run::global_mutex.lock();
+	Run::_ops_per_chain = local_ops_per_chain;
+	Run::global_mutex.unlock();
+
+	return root;
+}
+
+Chain*
+Run::window_mem_init(Chain *mem, int64 pages) {
+	// initialize pointers --
+	// walk through the chain one window at
+	// a time, visiting the lines within each
+	// window in uniform random order. the
+	// window size bounds the reuse distance.
+	Chain* root = 0;
+	Chain* prev = 0;
+	int64 local_ops_per_chain = 0;
+
+	int64 lines = pages * this->exp->lines_per_page;
+	int64 lines_per_window = std::min(lines,
+			this->exp->bytes_per_window / this->exp->bytes_per_stride);
+	std::vector<int64> line_seq(lines_per_window);
+
+	// loop through the windows
+	for (int64 first = 0; first < lines; first += lines_per_window) {
+		int64 n = std::min(lines_per_window, lines - first);
+		for (int64 j = 0; j < n; j++) {
+			line_seq[j] = first + j;
+		}
+		for (int64 j = n - 1; 0 < j; j--) {
+			std::swap(line_seq[j], line_seq[this->rng.uniform(j + 1)]);
+		}
+
+		// loop through the lines within a window
+		for (int64 j = 0; j < n; j++) {
+			int64 link = line_seq[j] * this->exp->links_per_line;
+
+			if (root == 0) {
+				prev = root = this->place(mem, link);
+				local_ops_per_chain += 1;
+			} else {
+				prev->next = this->place(mem, link);
+				prev = prev->next;
+				local_ops_per_chain += 1;
+			}
+		}
+	}
+
+	prev->next = root;
+
+	Run::global_mutex.lock();
+	Run::_ops_per_chain = local_ops_per_chain;
+	Run::global_mutex.unlock();
+
+	return root;
+}
+
+Chain*
+Run::skewed_mem_init(Chain *mem, int64 pages) {
+	// initialize pointers --
+	// give the visits the experiment counted
+	// per popularity rank, Zipf(s) or hot/cold,
+	// to randomly ranked lines. the visits are
+	// chased in random order, each one through
+	// a link of its own within its line. when
+	// a payload is written, it takes the word
+	// after each link.
+	Chain* root = 0;
+	Chain* prev = 0;
+	int64 local_ops_per_chain = 0;
+
+	int64 lines = pages * this->exp->lines_per_page;
+	int64 step = (this->exp->memory_operation == Experiment::LOAD) ? 1 : 2;
+
+	// rank the lines randomly
+	std::vector<int64> rank(lines);
+	for (int64 r = 0; r < lines; r++)
+		rank[r] = r;
+	for (int64 r = lines - 1; 0 < r; r--)
+		std::swap(rank[r], rank[this->rng.uniform(r + 1)]);
+
+	std::vector<int32> visits(lines);
+	int64 total = 0;
+	for (int64 r = 0; r < lines; r++) {
+		visits[rank[r]] = this->exp->visits[r];
+		total += this->exp->visits[r];
+	}
+
+	// list and shuffle the visits
+	std::vector<int64> order(total);
+	int64 k = 0;
+	for (int64 line = 0; line < lines; line++)
+		for (int32 v = 0; v < visits[line]; v++)
+			order[k++] = line;
+	for (int64 i = total - 1; 0 < i; i--)
+		std::swap(order[i], order[this->rng.uniform(i + 1)]);
+
+	// link the visits, counting down the links of each line
+	for (int64 i = 0; i < total; i++) {
+		int64 line = order[i];
+		visits[line] -= 1;
+		int64 link = line * this->exp->links_per_line + visits[line] * step;
+
+		if (root == 0) {
 			prev = root = mem + link;
 			local_ops_per_chain += 1;
 		} else {
@@ -313,20 +909,25 @@ Run::forward_mem_init(Chain *mem) {
 }
 
 Chain*
-Run::reverse_mem_init(Chain *mem) {
+Run::trace_mem_init(Chain *mem, int64 pages) {
+	// initialize pointers --
+	// follow the recorded lines in order,
+	// every visit through a link of its own
+	// within its line. the experiment already
+	// dropped the visits that find no link.
 	Chain* root = 0;
 	Chain* prev = 0;
-	int link_within_line = 0;
 	int64 local_ops_per_chain = 0;
 
-	int stride = -this->exp->stride;
-	int last;
-	for (int i = 0; i < this->exp->lines_per_chain; i += stride) {
-		last = i;
-	}
+	int64 lines = pages * this->exp->lines_per_page;
+	int64 step = (this->exp->memory_operation == Experiment::LOAD) ? 1 : 2;
+
+	std::vector<int32> visits(lines);
+	for (int64 i = 0; i < this->exp->trace_length; i++) {
+		int64 line = this->exp->trace[i];
+		int64 link = line * this->exp->links_per_line + visits[line] * step;
+		visits[line] += 1;
 
-	for (int i = last; 0 <= i; i -= stride) {
-		int link = i * this->exp->links_per_line + link_within_line;
 		if (root == 0) {
 			prev = root = mem + link;
 			local_ops_per_chain += 1;
@@ -346,13 +947,206 @@ Run::reverse_mem_init(Chain *mem) {
 	return root;
 }
 
-static benchmark chase_pointers(int64 chains_per_thread, // memory loading per thread
-		int64 bytes_per_line, // ignored
-		int64 bytes_per_chain, // ignored
-		int64 stride, // ignored
-		int64 loop_length, // length of the inner loop
+Chain*
+Run::forward_mem_init(Chain *mem, int64 pages) {
+	Chain* root = 0;
+	Chain* prev = 0;
+	int64 local_ops_per_chain = 0;
+
+	int64 lines = pages * this->exp->lines_per_page;
+	for (int64 i = 0; i < lines; i += this->exp->stride) {
+		int64 link = i * this->exp->links_per_line;
+		if (root == NULL) {
+			prev = root = this->place(mem, link);
+			local_ops_per_chain += 1;
+		} else {
+			prev->next = this->place(mem, link);
+			prev = prev->next;
+			local_ops_per_chain += 1;
+		}
+	}
+
+	prev->next = root;
+
+	Run::global_mutex.lock();
+	Run::_ops_per_chain = local_ops_per_chain;
+	Run::global_mutex.unlock();
+
+	return root;
+}
+
+Chain*
+Run::reverse_mem_init(Chain *mem, int64 pages) {
+	Chain* root = 0;
+	Chain* prev = 0;
+	int64 local_ops_per_chain = 0;
+
+	int64 stride = -this->exp->stride;
+	int64 lines = pages * this->exp->lines_per_page;
+	int64 last = (lines - 1) / stride * stride;
+
+	for (int64 i = last; 0 <= i; i -= stride) {
+		int64 link = i * this->exp->links_per_line;
+		if (root == 0) {
+			prev = root = this->place(mem, link);
+			local_ops_per_chain += 1;
+		} else {
+			prev->next = this->place(mem, link);
+			prev = prev->next;
+			local_ops_per_chain += 1;
+		}
+	}
+
+	prev->next = root;
+
+	Run::global_mutex.lock();
+	Run::_ops_per_chain = local_ops_per_chain;
+	Run::global_mutex.unlock();
+
+	return root;
+}
+
+static void prefetch(AsmJit::Compiler &c,
+		const AsmJit::Mem &address, // address to prefetch
 		int32 prefetch_hint // use of prefetching
 		) {
+	switch (prefetch_hint)
+	{
+	case Experiment::T0:
+		c.prefetch(address, AsmJit::PREFETCH_T0);
+		break;
+	case Experiment::T1:
+		c.prefetch(address, AsmJit::PREFETCH_T1);
+		break;
+	case Experiment::T2:
+		c.prefetch(address, AsmJit::PREFETCH_T2);
+		break;
+	case Experiment::NTA:
+		c.prefetch(address, AsmJit::PREFETCH_NTA);
+		break;
+	case Experiment::NONE:
+	default:
+		break;
+
+	}
+}
+
+static void touch(AsmJit::Compiler &c,
+		AsmJit::GPVar &position, // line to operate on
+		int32 memory_operation, // operation performed on each line
+		int64 payload_offset // offset of the payload from the link
+		) {
+	// The payload is the word next to the link, so
+	// the store dirties the line that was just loaded.
+	switch (memory_operation)
+	{
+	case Experiment::STORE:
+		c.mov(sysint_ptr(position, payload_offset), position);
+		break;
+	case Experiment::RMW:
+		c.add(sysint_ptr(position, payload_offset), AsmJit::imm(1));
+		break;
+	case Experiment::LOAD:
+	default:
+		break;
+
+	}
+}
+
+// the rest of the node read by each hop, kept local to this
+// file like the AsmJit variables it holds
+namespace {
+struct Node {
+	int64 bytes;			// bytes per node, 0 for a single line
+	int64 line;				// bytes per cache line
+	bool simd;				// read the whole node with 16-byte loads
+	AsmJit::GPVar word;		// scratch register of scalar loads
+	AsmJit::XMMVar vector;	// scratch register of SIMD loads
+};
+}
+
+static void read_node(AsmJit::Compiler &c,
+		AsmJit::GPVar &position, // node to read
+		Node &node // node geometry and scratch registers
+		) {
+	// The loads only depend on the position, so they
+	// overlap with the load of the next link.
+	if (node.simd) {
+		for (int64 offset = 0; offset < node.bytes; offset += 16)
+			c.movdqa(node.vector, ptr(position, offset));
+	} else {
+		for (int64 offset = node.line; offset < node.bytes; offset += node.line)
+			c.mov(node.word, ptr(position, offset));
+	}
+}
+
+static void chase_links(AsmJit::Compiler &c,
+		std::vector<AsmJit::GPVar> &positions, // current position of each chain
+		std::vector<AsmJit::GPVar> &leads, // prefetching position of each chain, if any
+		int64 loop_length, // length of the inner loop
+		int32 prefetch_hint, // use of prefetching
+		int32 memory_operation, // operation performed on each line
+		int64 payload_offset, // offset of the payload from the link
+		Node &node // rest of the node read by each hop
+		) {
+	// Process all links
+	for (size_t i = 0; i < positions.size(); i++) {
+		// Read the node and chase pointer
+		read_node(c, positions[i], node);
+		c.mov(positions[i], ptr(positions[i], offsetof(Chain, next)));
+
+		// Dirty the line
+		touch(c, positions[i], memory_operation, payload_offset);
+
+		// Prefetch next, or the line the leading
+		// cursor has reached when there is one
+		if (leads.empty()) {
+			prefetch(c, ptr(positions[i]), prefetch_hint);
+		} else {
+			c.mov(leads[i], ptr(leads[i], offsetof(Chain, next)));
+			prefetch(c, ptr(leads[i]), prefetch_hint);
+		}
+	}
+
+	// Wait
+	for (int i = 0; i < loop_length; i++)
+		c.nop();
+}
+
+static void chase_links_wide(AsmJit::Compiler &c,
+		AsmJit::GPVar &cursors, // array holding the position of each chain
+		int64 chains_per_thread, // memory loading per thread
+		AsmJit::GPVar &position, // scratch register
+		int64 loop_length, // length of the inner loop
+		int32 prefetch_hint, // use of prefetching
+		int32 memory_operation, // operation performed on each line
+		int64 payload_offset, // offset of the payload from the link
+		Node &node // rest of the node read by each hop
+		) {
+	// Process all links. Every chain goes through the same scratch
+	// register, which register renaming turns into as many independent
+	// loads as fit in the out-of-order window. The cursor array itself
+	// stays in L1, and its load and store are off the critical path.
+	for (int i = 0; i < chains_per_thread; i++) {
+		// Chase pointer
+		c.mov(position, ptr(cursors, i * sizeof(Chain*)));
+		read_node(c, position, node);
+		c.mov(position, ptr(position, offsetof(Chain, next)));
+		c.mov(ptr(cursors, i * sizeof(Chain*)), position);
+
+		// Dirty the line
+		touch(c, position, memory_operation, payload_offset);
+
+		// Prefetch next
+		prefetch(c, ptr(position), prefetch_hint);
+	}
+
+	// Wait
+	for (int i = 0; i < loop_length; i++)
+		c.nop();
+}
+
+static benchmark chase_pointers(Experiment &e, int64 ops_per_chain) {
 	// Create Compiler.
 	AsmJit::Compiler c;
 
@@ -365,63 +1159,344 @@ static benchmark chase_pointers(int64 chains_per_thread, // memory loading per t
 
 	// Create labels.
 	AsmJit::Label L_Loop = c.newLabel();
+	AsmJit::Label L_Tail = c.newLabel();
 
 	// Function arguments.
 	AsmJit::GPVar chain(c.argGP(0));
 
-	// Save the head
-	std::vector<AsmJit::GPVar> heads(chains_per_thread);
-	for (int i = 0; i < chains_per_thread; i++) {
-		AsmJit::GPVar head = c.newGP();
-		c.mov(head, ptr(chain));
-		heads[i] = head;
+	// Current position, starting at the root of each chain. When
+	// there are too many chains to keep in registers, the root array
+	// itself holds the cursors; after a full cycle every cursor is
+	// back at its root, leaving the array unchanged.
+	bool wide = MAX_REGISTER_CHAINS < e.chains_per_thread;
+	std::vector<AsmJit::GPVar> positions;
+	AsmJit::GPVar scratch;
+	if (wide) {
+		scratch = c.newGP();
+	} else {
+		positions.resize(e.chains_per_thread);
+		for (int i = 0; i < e.chains_per_thread; i++) {
+			AsmJit::GPVar position = c.newGP();
+			c.mov(position, ptr(chain, i * sizeof(Chain*)));
+			positions[i] = position;
+		}
 	}
 
-	// Current position
-	std::vector<AsmJit::GPVar> positions(chains_per_thread);
-	for (int i = 0; i < chains_per_thread; i++) {
-		AsmJit::GPVar position = c.newGP();
-		c.mov(position, heads[0]);
-		positions[i] = position;
+	// Leading cursors, walked e.prefetch_distance hops ahead
+	// of each chain before the loop starts. Chains are cycles,
+	// so the leading cursor never runs off the end.
+	std::vector<AsmJit::GPVar> leads;
+	if (0 < e.prefetch_distance) {
+		leads.resize(e.chains_per_thread);
+		for (int i = 0; i < e.chains_per_thread; i++) {
+			AsmJit::GPVar lead = c.newGP();
+			c.mov(lead, positions[i]);
+			for (int d = 0; d < e.prefetch_distance; d++)
+				c.mov(lead, ptr(lead, offsetof(Chain, next)));
+			leads[i] = lead;
+		}
+	}
+
+	// Node geometry. Without a node size every hop reads a single line.
+	Node node;
+	node.bytes = e.bytes_per_node;
+	node.line = cache_line_size();
+	node.simd = e.node_simd;
+	if (0 < node.bytes) {
+		if (node.simd)
+			node.vector = c.newXMM();
+		else
+			node.word = c.newGP();
 	}
 
+	// Remaining unrolled blocks. Chains do not share their layout,
+	// so rather than comparing a single chain against its head, every
+	// chain is advanced exactly one full cycle back to its own root:
+	// the loop covers whole blocks of e.unroll links, and the links
+	// that do not fill a block are chased once more after the loop.
+	int64 blocks = ops_per_chain / e.unroll;
+	int64 remainder = ops_per_chain % e.unroll;
+	AsmJit::GPVar count = c.newGP();
+	c.mov(count, AsmJit::imm(blocks));
+	c.test(count, count);
+	c.jz(L_Tail);
+
 	// Loop.
 	c.bind(L_Loop);
 
+	// Process an unrolled block of links
+	for (int u = 0; u < e.unroll; u++) {
+		if (wide)
+			chase_links_wide(c, chain, e.chains_per_thread, scratch, e.loop_length, e.prefetch_hint, e.memory_operation, e.payload_offset, node);
+		else
+			chase_links(c, positions, leads, e.loop_length, e.prefetch_hint, e.memory_operation, e.payload_offset, node);
+	}
+
+	// Test if end reached
+	c.sub(count, AsmJit::imm(1));
+	c.jnz(L_Loop);
+
+	// Process the remaining links
+	c.bind(L_Tail);
+	for (int u = 0; u < remainder; u++) {
+		if (wide)
+			chase_links_wide(c, chain, e.chains_per_thread, scratch, e.loop_length, e.prefetch_hint, e.memory_operation, e.payload_offset, node);
+		else
+			chase_links(c, positions, leads, e.loop_length, e.prefetch_hint, e.memory_operation, e.payload_offset, node);
+	}
+
+	// Finish.
+	c.endFunction();
+
+	// Make JIT function.
+	benchmark fn = AsmJit::function_cast<benchmark>(c.make());
+
+	// Ensure that everything is ok.
+	if (!fn) {
+		printf("Error making jit function (%u).\n", c.getError());
+		return 0;
+	}
+
+	return fn;
+}
+
+//
+// Native engine
+//
+
+static benchmark chase_native(Experiment &e, int64 ops_per_chain) {
+	return Native::select(e, ops_per_chain);
+}
+
+//
+// Gather engine
+//
+
+/*
+ * The bundled AsmJit predates AVX, so the few VEX and EVEX encoded
+ * instructions used by the gather engine are emitted as raw bytes.
+ * The Compiler cannot allocate registers around raw bytes, hence this
+ * kernel is written against the Assembler using fixed registers:
+ * group g of gather_width chains ping-pongs between vector registers
+ * 2g and 2g+1, ymm15 is the AVX2 gather mask, and k(g+1) is the
+ * AVX-512 gather mask of group g.
+ */
+
+static const int GATHER_MASK_YMM = 15;
+
+// VEX prefix, three byte form
+static void emit_vex3(AsmJit::Assembler &a, int r, int x, int b, int map, int w, int v, int l, int pp) {
+	a.db(0xC4);
+	a.db(((~r & 8) << 4) | ((~x & 8) << 3) | ((~b & 8) << 2) | map);
+	a.db((w << 7) | ((~v & 15) << 3) | (l << 2) | pp);
+}
+
+// EVEX prefix for 512-bit operations on registers 0..15
+static void emit_evex(AsmJit::Assembler &a, int r, int x, int b, int map, int w, int v, int pp, int mask) {
+	a.db(0x62);
+	a.db(((~r & 8) << 4) | ((~x & 8) << 3) | ((~b & 8) << 2) | 0x10 | map);
+	a.db((w << 7) | ((~v & 15) << 3) | 0x04 | pp);
+	a.db(0x40 | 0x08 | mask);
+}
+
+// vmovdqu ymm/zmm(dst), [rdi + offset]
+static void emit_load_roots(AsmJit::Assembler &a, int width, int dst, int32 offset) {
+	if (width == 8)
+		emit_evex(a, dst, 0, AsmJit::REG_INDEX_RDI, 1, 1, 0, 2, 0);
+	else
+		emit_vex3(a, dst, 0, AsmJit::REG_INDEX_RDI, 1, 0, 0, 1, 2);
+	a.db(0x6F);
+	a.db(0x80 | ((dst & 7) << 3) | (AsmJit::REG_INDEX_RDI & 7));
+	a.dd(offset);
+}
+
+// vmovdqa ymm/zmm(dst), ymm/zmm(src)
+static void emit_move(AsmJit::Assembler &a, int width, int dst, int src) {
+	if (width == 8)
+		emit_evex(a, dst, 0, src, 1, 1, 0, 1, 0);
+	else
+		emit_vex3(a, dst, 0, src, 1, 0, 0, 1, 1);
+	a.db(0x6F);
+	a.db(0xC0 | ((dst & 7) << 3) | (src & 7));
+}
+
+// vpgatherqq ymm/zmm(dst), [ymm/zmm(index) + offset], with all lanes enabled
+static void emit_gather(AsmJit::Assembler &a, int width, int dst, int index, int mask, int32 offset) {
+	if (width == 8) {
+		// kxnorw k, k, k
+		emit_vex3(a, mask, 0, mask, 1, 0, mask, 1, 0);
+		a.db(0x46);
+		a.db(0xC0 | (mask << 3) | mask);
+		emit_evex(a, dst, index, 0, 2, 1, 0, 1, mask);
+	} else {
+		// vpcmpeqd ymm, ymm, ymm
+		emit_vex3(a, GATHER_MASK_YMM, 0, GATHER_MASK_YMM, 1, 0, GATHER_MASK_YMM, 1, 1);
+		a.db(0x76);
+		a.db(0xC0 | ((GATHER_MASK_YMM & 7) << 3) | (GATHER_MASK_YMM & 7));
+		emit_vex3(a, dst, index, 0, 2, 1, GATHER_MASK_YMM, 1, 1);
+	}
+	a.db(0x91);
+	a.db(((dst & 7) << 3) | 4);		// SIB follows, no base
+	a.db(((index & 7) << 3) | 5);	// scale 1, 32-bit displacement
+	a.dd(offset);
+}
+
+static void gather_links(AsmJit::Assembler &a,
+		std::vector<int> &cursors, // register holding each group of chains
+		int width, // chains per gather
+		int64 loop_length // length of the inner loop
+		) {
 	// Process all links
-	for (int i = 0; i < chains_per_thread; i++) {
-		// Chase pointer
-		c.mov(positions[i], ptr(positions[i], offsetof(Chain, next)));
+	for (size_t g = 0; g < cursors.size(); g++) {
+		int next = cursors[g] ^ 1;
+		emit_gather(a, width, next, cursors[g], g + 1, offsetof(Chain, next));
+		cursors[g] = next;
+	}
 
-		// Prefetch next
-		switch (prefetch_hint)
-		{
-		case Experiment::T0:
-			c.prefetch(ptr(positions[i]), AsmJit::PREFETCH_T0);
+	// Wait
+	for (int i = 0; i < loop_length; i++)
+		a.nop();
+}
+
+static benchmark chase_gather(Experiment &e, int64 ops_per_chain) {
+	// Create Assembler. The root array arrives in rdi
+	// following the System V calling convention.
+	AsmJit::Assembler a;
+	int width = e.gather_width;
+	int groups = e.chains_per_thread / width;
+
+	// Create labels.
+	AsmJit::Label L_Loop = a.newLabel();
+	AsmJit::Label L_Tail = a.newLabel();
+
+	// Current position, starting at the root of each chain
+	std::vector<int> cursors(groups);
+	for (int g = 0; g < groups; g++) {
+		cursors[g] = 2 * g;
+		emit_load_roots(a, width, cursors[g], g * width * sizeof(Chain*));
+	}
+
+	// Remaining unrolled blocks, as in chase_pointers()
+	int64 blocks = ops_per_chain / e.unroll;
+	int64 remainder = ops_per_chain % e.unroll;
+	a.mov(AsmJit::rcx, AsmJit::imm(blocks));
+	a.test(AsmJit::rcx, AsmJit::rcx);
+	a.jz(L_Tail);
+
+	// Loop.
+	a.bind(L_Loop);
+
+	// Process an unrolled block of links
+	for (int u = 0; u < e.unroll; u++)
+		gather_links(a, cursors, width, e.loop_length);
+
+	// Move the cursors back to their initial registers,
+	// which only takes code when the unroll factor is odd
+	for (int g = 0; g < groups; g++) {
+		if (cursors[g] != 2 * g) {
+			emit_move(a, width, 2 * g, cursors[g]);
+			cursors[g] = 2 * g;
+		}
+	}
+
+	// Test if end reached
+	a.sub(AsmJit::rcx, AsmJit::imm(1));
+	a.jnz(L_Loop);
+
+	// Process the remaining links
+	a.bind(L_Tail);
+	for (int u = 0; u < remainder; u++)
+		gather_links(a, cursors, width, e.loop_length);
+
+	// Finish: vzeroupper avoids AVX-SSE transition penalties in the caller
+	a.db(0xC5);
+	a.db(0xF8);
+	a.db(0x77);
+	a.ret();
+
+	// Make JIT function.
+	benchmark fn = AsmJit::function_cast<benchmark>(a.make());
+
+	// Ensure that everything is ok.
+	if (!fn) {
+		printf("Error making jit function (%u).\n", a.getError());
+		return 0;
+	}
+
+	return fn;
+}
+
+//
+// Stream engine
+//
+
+static benchmark stream_stores(Experiment &e, int32 store) {
+	// Create Compiler.
+	AsmJit::Compiler c;
+
+	// The argument is the array of chain memory
+	// blocks, rather than the roots of the chains.
+	c.newFunction(AsmJit::CALL_CONV_DEFAULT, AsmJit::FunctionBuilder1<AsmJit::Void, const Chain**>());
+	c.getFunction()->setHint(AsmJit::FUNCTION_HINT_NAKED, true);
+
+	// Function arguments.
+	AsmJit::GPVar memory(c.argGP(0));
+
+	// Values to store
+	AsmJit::GPVar zero = c.newGP();
+	AsmJit::XMMVar vzero = c.newXMM();
+	c.xor_(zero, zero);
+	c.pxor(vzero, vzero);
+
+	AsmJit::GPVar position = c.newGP();
+	AsmJit::GPVar end = c.newGP();
+	for (int i = 0; i < e.chains_per_thread; i++) {
+		c.mov(position, ptr(memory, i * sizeof(Chain*)));
+
+		if (store == REP_STOSB) {
+			c.mov(end, AsmJit::imm(e.bytes_per_chain));
+			c.rep_stosb(position, zero, end);
+			continue;
+		}
+
+		// Write one line per iteration
+		AsmJit::Label L_Loop = c.newLabel();
+		c.mov(end, AsmJit::imm(e.bytes_per_chain));
+		c.add(end, position);
+		c.bind(L_Loop);
+
+		switch (store) {
+		case MOV:
+			for (int j = 0; j < e.bytes_per_line; j += sizeof(sysint_t))
+				c.mov(sysint_ptr(position, j), zero);
 			break;
-		case Experiment::T1:
-			c.prefetch(ptr(positions[i]), AsmJit::PREFETCH_T1);
+		case MOVDQA:
+			for (int j = 0; j < e.bytes_per_line; j += 16)
+				c.movdqa(ptr(position, j), vzero);
 			break;
-		case Experiment::T2:
-			c.prefetch(ptr(positions[i]), AsmJit::PREFETCH_T2);
+		case MOVNTI:
+			for (int j = 0; j < e.bytes_per_line; j += sizeof(sysint_t))
+				c.movnti(sysint_ptr(position, j), zero);
 			break;
-		case Experiment::NTA:
-			c.prefetch(ptr(positions[i]), AsmJit::PREFETCH_NTA);
+		case MOVNTDQ:
+			for (int j = 0; j < e.bytes_per_line; j += 16)
+				c.movntdq(ptr(position, j), vzero);
 			break;
-		case Experiment::NONE:
-		default:
+		case MOVNTPS:
+			for (int j = 0; j < e.bytes_per_line; j += 16)
+				c.movntps(ptr(position, j), vzero);
 			break;
-
 		}
-	}
 
-	// Wait
-	for (int i = 0; i < loop_length; i++)
-		c.nop();
+		// Test if end reached
+		c.add(position, AsmJit::imm(e.bytes_per_line));
+		c.cmp(position, end);
+		c.jb(L_Loop);
+	}
 
-	// Test if end reached
-	c.cmp(heads[0], positions[0]);
-	c.jne(L_Loop);
+	// Non-temporal stores are weakly ordered
+	if (store == MOVNTI || store == MOVNTDQ || store == MOVNTPS)
+		c.sfence();
 
 	// Finish.
 	c.endFunction();
@@ -29,6 +29,38 @@
 #include "types.h"
 #include "experiment.h"
 #include "spinbarrier.h"
+#include "random.h"
+
+
+//
+// Type definitions
+//
+
+typedef void (*benchmark)(const Chain**);
+
+// results of the stream engine, for one store instruction
+struct Stream {
+	const char* store;				// store instruction
+	int64 iterations;				// iterations per experiment
+	std::vector<double> seconds;	// number of seconds for each experiment
+};
+
+// results of a numa matrix, for one pair of domains
+struct Pair {
+	int32 cpu_domain;				// domain the threads run on
+	int32 memory_domain;			// domain the chains are allocated on
+	int64 threads;					// threads of the bandwidth run
+	const char* tier;				// tier of the memory, as seen from the cpus
+	double latency;					// latency of a single chain (ns)
+	double bandwidth;				// bandwidth of all threads (MB/s)
+};
+
+// results of a prefetch distance sweep, for one distance
+struct Sweep {
+	int64 distance;					// prefetch distance (hops)
+	int64 iterations;				// iterations per experiment
+	std::vector<double> seconds;	// number of seconds for each experiment
+};
 
 
 //
@@ -48,19 +80,42 @@ public:
 	static std::vector<double> seconds() {
 		return _seconds;
 	}
+	static std::vector<Stream> streams() {
+		return _streams;
+	}
+	static std::vector<Sweep> sweeps() {
+		return _sweeps;
+	}
+	static void reset();
 
 private:
 	Experiment* exp; // experiment data
 	SpinBarrier* bp; // spin barrier used by all threads
+	Chain** chain_memory; // memory of the chains of this thread
+	Random rng; // random number generator of this thread
+
+	void measure(benchmark bench, const Chain** arg, int64 &iterations,
+			std::vector<double> &seconds);
+	double timed(benchmark bench, const Chain** arg, int64 iterations);
+	void flush();
 
 	void mem_check(Chain *m);
-	Chain* random_mem_init(Chain *m);
-	Chain* forward_mem_init(Chain *m);
-	Chain* reverse_mem_init(Chain *m);
+	Chain* place(Chain *m, int64 link);
+	Chain* random_mem_init(Chain *m, int64 pages);
+	Chain* permute_mem_init(Chain *m, int64 pages);
+	Chain* permute_pages_mem_init(Chain *m, int64 pages);
+	Chain* ordered_mem_init(Chain *m, int64 pages);
+	Chain* window_mem_init(Chain *m, int64 pages);
+	Chain* skewed_mem_init(Chain *m, int64 pages);
+	Chain* trace_mem_init(Chain *m, int64 pages);
+	Chain* forward_mem_init(Chain *m, int64 pages);
+	Chain* reverse_mem_init(Chain *m, int64 pages);
 
 	static Lock global_mutex; // global lock
 	static int64 _ops_per_chain; // total number of operations per chain
 	static std::vector<double> _seconds; // number of seconds for each experiment
+	static std::vector<Stream> _streams; // results of the stream engine
+	static std::vector<Sweep> _sweeps; // results of the prefetch distance sweep
 };
 
 #endif
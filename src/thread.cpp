@@ -71,6 +71,14 @@ Thread::start_routine(void* p) {
 	return NULL;
 }
 
+// number the threads created from now on from 0 again,
+// once all earlier threads have been waited for
+void Thread::reset() {
+	Thread::global_lock();
+	Thread::count = 0;
+	Thread::global_unlock();
+}
+
 void Thread::exit() {
 	pthread_exit(NULL);
 }
@@ -45,6 +45,7 @@ public:
 	}
 
 	static void exit();
+	static void reset();
 
 protected:
 	~Thread();